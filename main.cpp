@@ -1,13 +1,31 @@
 #include <OneWire.h>
-#include <DallasTemperature.h>
 #include <Arduino.h>
+#include <util/atomic.h>
+#include <avr/wdt.h>
+#include <util/crc16.h>
+#include <EEPROM.h>
 // -----------------------------------------------------------------------------
 // Configuration
 // -----------------------------------------------------------------------------
 
 constexpr bool CONNECT_TO_PC{ true };
 
+// What goes over the wire when connected (see Telemetry):
+//   Text      - readable lines
+//   Binary    - PrintState() as binary frames, everything else as text
+//   Tokenized - Binary, plus every Log message as a token frame (see LOG_STR)
+enum class TelemetryMode : uint8_t { Text, Binary, Tokenized };
+constexpr TelemetryMode TELEMETRY{ TelemetryMode::Text };
+
+// Compiled defaults of the runtime settings (see Config); ZONES has the per-zone ones.
 constexpr float TEMP_ALLOWANCE { 0.25f };
+constexpr float DESYNC_RISE_C { 0.25f };           // heating must raise the temp this much ...
+constexpr unsigned long DESYNC_WAIT_MS{ 300000UL }; // ... within 5 minutes
+
+// Bounds for a target set at runtime (see Config): never below TARGET_MIN_C and
+// always at least TARGET_MARGIN_C under the zone's max once the band is added.
+constexpr float TARGET_MIN_C { 15.0f };
+constexpr float TARGET_MARGIN_C { 1.0f };
 
 
 // Relay logic level.
@@ -15,429 +33,3704 @@ constexpr float TEMP_ALLOWANCE { 0.25f };
 constexpr uint8_t RELAY_ACTIVE_STATE{ HIGH };
 constexpr uint8_t RELAY_INACTIVE_STATE{ LOW };
 
+// Log filtering (see LogAt). Anything above LOG_LEVEL or outside LOG_SYSTEMS is not
+// compiled in at all; what is compiled in can still be muted at runtime over serial.
+// For production LogLevel::Error keeps panic reports but drops the state lines.
+enum class LogLevel : uint8_t { Error = 0, Warn, Info, Debug };
+enum class LogSys : uint8_t { Control = 0, Sensor, Panic, LED, System };
+constexpr LogLevel LOG_LEVEL{ LogLevel::Info };
+constexpr uint8_t LOG_SYSTEMS{ 0x1FU }; // bit per LogSys
+
+// One entry per heated zone. Controllers, panic shutdown, the LED, the supervisor,
+// the watchdog, history and the console are all sized and wired from this table.
+// Keep the relay pins on one port (PORTB here) so a panic drops them in one write.
+// probes: 1..3 DS18B20s on the sensor pin, voted into one reading (PROBE_VOTE).
+// mat_w: rated power of the heat mat(s) on the relay, for Energy.
+struct ZoneConfig
+{
+  uint8_t uid;
+  float target_c;
+  float max_c;
+  uint8_t sensor_pin;
+  uint8_t relay_pin;
+  uint8_t probes;
+  uint16_t mat_w;
+};
+constexpr ZoneConfig ZONES[]
+{
+  // uid, target, max, sensor pin, relay pin, probes, mat W
+  { 1U, 24.0f, 28.0f, 2U,  8U, 1U, 14U }, // nico
+  { 2U, 25.0f, 29.0f, 4U, 12U, 1U, 14U }  // trap
+};
+constexpr uint8_t ZONE_COUNT{ sizeof(ZONES) / sizeof(ZONES[0]) };
+constexpr uint8_t TotalProbes(uint8_t const i = 0U)
+{
+  return i < ZONE_COUNT ? static_cast<uint8_t>(ZONES[i].probes + TotalProbes(i + 1U)) : 0U;
+}
+
+// DS18B20 resolution, 9..12 bits; conversion takes 94 ms at 9 bits up to 750 ms at 12
+constexpr uint8_t SENSOR_BITS{ 12U };
+constexpr unsigned long SENSOR_CONVERT_MS{ 750UL >> (12U - SENSOR_BITS) };
+
+// Zones with more than one probe (see Ds18b20): Median rides out one bad probe,
+// Max never under-reads. Probes further apart than PROBE_DISAGREE_C are a
+// ProbeDisagree fault, typically one that slipped out of the heated area.
+enum class ProbeVote : uint8_t { Median, Max };
+constexpr ProbeVote PROBE_VOTE{ ProbeVote::Median };
+constexpr float PROBE_DISAGREE_C{ 1.5f };
+
 // How often to read temperature (ms)
 constexpr unsigned long READ_INTERVAL_MS{ 3000UL };  // 3 seconds
+constexpr unsigned long READ_INTERVAL_MAX_MS{ 5000UL }; // runtime limit, see below
+
+// Per-zone summary window (see WindowStats). State lines go out on change only and
+// a summary once per window; 0 restores one state line per sample.
+constexpr unsigned long STATS_WINDOW_MS{ 60000UL }; // 1 minute
+
+// Worst case from a sample's start to its value: the conversion, then every zone
+// taking its turn on the one 1-Wire bus (OwEngine), a CONVERT T per zone and a
+// scratchpad read per probe at up to OW_TRANSACTION_MS each (reset, MATCH ROM and
+// 9 bytes back at ~70 us a bit), plus LOOP_SLACK_MS of loop() passes in between.
+// It is also the shortest read interval Config accepts.
+constexpr unsigned long OW_TRANSACTION_MS{ 12UL };
+constexpr unsigned long LOOP_SLACK_MS{ 250UL };
+constexpr unsigned long SAMPLE_LATENCY_MS{ SENSOR_CONVERT_MS + OW_TRANSACTION_MS * (ZONE_COUNT + TotalProbes()) + LOOP_SLACK_MS };
+static_assert(SAMPLE_LATENCY_MS <= READ_INTERVAL_MS, "READ_INTERVAL_MS is shorter than a sample takes");
+
+// Safety supervisor (see Supervisor): a zone whose last good sample is older
+// than this gets its relay forced off from the timer ISR. One missed sample at
+// the slowest interval must not trip it: two intervals plus SAMPLE_LATENCY_MS.
+// The supervisor owns Timer2, so analogWrite() does not work on pins 3 and 11.
+constexpr unsigned long SUPERVISOR_STALE_MS{ 4UL * READ_INTERVAL_MS };
+static_assert(2UL * READ_INTERVAL_MAX_MS + SAMPLE_LATENCY_MS <= SUPERVISOR_STALE_MS,
+              "a slow read interval would trip the supervisor");
+
+// While latched the full panic record is printed once; after that a one line
+// heartbeat, its interval doubling from MIN up to MAX.
+constexpr unsigned long PANIC_REPORT_MIN_MS{ 5000UL };
+constexpr unsigned long PANIC_REPORT_MAX_MS{ 600000UL }; // 10 minutes
+
+// Fault domains (see Panic::IsZoneScoped): with ZONE_FAULTS a sensor fault
+// (disconnect, no rise, probes disagreeing) only turns its own zone off and the others keep heating.
+// OverMax is a zone fault too with OVERMAX_ZONE_FAULT, else a global panic like the
+// supervisor, the watchdog and everything else.
+constexpr bool ZONE_FAULTS{ true };
+constexpr bool OVERMAX_ZONE_FAULT{ false };
+
+// Sensor recovery (see TempController::Rediscover): a zone faulted by a lost sensor
+// searches its bus again, first after SENSOR_RETRY_MIN_MS and then doubling up to
+// SENSOR_RETRY_MAX_MS, and heats again after RECOVERY_SAMPLES good samples in a row.
+// Needs ZONE_FAULTS; a global panic still takes a power cycle.
+// A sensor lost again within SENSOR_FLAP_QUIET_MS of being readmitted is flapping:
+// the repeats are counted and logged but not journaled, so a loose connector
+// cannot wear the EEPROM or push every other record out of the Journal.
+constexpr bool SENSOR_RECOVERY{ true };
+constexpr unsigned long SENSOR_RETRY_MIN_MS{ 5000UL };
+constexpr unsigned long SENSOR_RETRY_MAX_MS{ 300000UL }; // 5 minutes
+constexpr uint8_t RECOVERY_SAMPLES{ 10U };
+constexpr unsigned long SENSOR_FLAP_QUIET_MS{ 3600000UL }; // 1 hour
+
+// EEPROM map (1 KB on the Uno). Regions never overlap; see each user for its layout.
+constexpr uint16_t EE_JOURNAL_BASE{ 0x000U };  // Journal, 256 bytes
+constexpr uint16_t EE_JOURNAL_SIZE{ 0x100U };
+constexpr uint16_t EE_CONFIG_BASE{ 0x100U };   // Config, 64 bytes
+constexpr uint16_t EE_CONFIG_SIZE{ 0x040U };
+constexpr unsigned long CONFIG_COMMIT_DELAY_MS{ 30000UL }; // quiet time before a Config write
+constexpr uint16_t EE_ENERGY_BASE{ 0x140U };   // Energy, 64 bytes
+constexpr uint16_t EE_ENERGY_SIZE{ 0x040U };
+constexpr uint16_t EE_HISTORY_BASE{ 0x180U };  // History, 640 bytes
+constexpr uint16_t EE_HISTORY_SIZE{ 0x280U };
+
+// On-board temperature history (see History), recorded with or without a PC.
+constexpr unsigned long HISTORY_INTERVAL_MS{ 60000UL }; // 1 minute
+
+// Heater energy (see Energy): reported and checkpointed every ENERGY_REPORT_MS,
+// and a day summary every ENERGY_DAY_REPORTS of those.
+constexpr unsigned long ENERGY_REPORT_MS{ 3600000UL }; // 1 hour
+constexpr uint8_t ENERGY_DAY_REPORTS{ 24U };
+
+// Free RAM watch (see Memory): warn once the stack has come this close to the
+// static data; checked every MEM_CHECK_MS.
+constexpr uint16_t MEM_WARN_BYTES{ 128U };
+constexpr unsigned long MEM_CHECK_MS{ 1000UL };
+
+// Section timing (see Profiler). Only takes effect with CONNECT_TO_PC.
+constexpr bool PROFILE_TIMING{ false };
+constexpr unsigned long PROFILE_REPORT_MS{ 60000UL }; // 1 minute
 
 // -----------------------------------------------------------------------------
-// Logger
+// Profiler
 // -----------------------------------------------------------------------------
+// Profiler: min/max/mean/count of micros() per code section.
+// Profiler<false> is all no-ops so instrumented call sites compile to nothing.
+//
+// Usage:
+//   { Prof::Scope const scope{ ProfSection::Control }; ...timed code... }
+//   Prof::Update();   // call regularly from loop(); reports and resets every PROFILE_REPORT_MS
+//
+// micros() ticks in 4 us steps on a 16 MHz board, so anything shorter reads as 0 or 4.
 
+enum class ProfSection : uint8_t
+{
+  Loop = 0,
+  Control,
+  SensorRead,
+  LogPrint,
+  COUNT
+};
 
-template<bool PC_CON>
-struct Logger;
+template<bool ENABLED>
+struct Profiler;
 
 template<>
-struct Logger<true>
+struct Profiler<true>
 {
-  static void begin(unsigned long baud)
+  struct Stat
   {
-    Serial.begin(baud);
-    // while(!Serial);
-  }
+    uint32_t count;
+    uint32_t total_us;
+    uint32_t min_us;
+    uint32_t max_us;
+  };
 
-  template<typename... T>
-  static void print(T const&... v)
+  class Scope
   {
-    //janky code expansion due to being on c++11
-    int const dummy[] = { 0, ((void)Serial.print(v), 0)... };
-    (void)dummy;
-  }
+  public:
+    explicit Scope(ProfSection const section):
+      start_us_(micros()),
+      section_(section)
+    {}
+    ~Scope() { Record(section_, micros() - start_us_); }
+  private:
+    uint32_t const start_us_;
+    ProfSection const section_;
+  };
 
-  template<typename... T>
-  static void println(T const&... v)
+  static void Record(ProfSection const section, uint32_t const us)
   {
-    print(v...);
-    Serial.println();
+    Stat& st = stats_[static_cast<uint8_t>(section)];
+    if(st.count == 0UL || us < st.min_us) st.min_us = us;
+    if(us > st.max_us) st.max_us = us;
+    st.total_us += us;
+    ++st.count;
   }
 
-  static void flush() { Serial.flush(); }
+  static void Update();
+
+private:
+  static Stat stats_[static_cast<uint8_t>(ProfSection::COUNT)];
+  static unsigned long last_report_ms_;
 };
 
 template<>
-struct Logger<false>
+struct Profiler<false>
 {
-  static void begin(unsigned long) {}
-  
-  template<typename... T>
-  static void print(T const&...) {}
-
-  template<typename... T>
-  static void println(T const&...) {}
+  struct Scope
+  {
+    explicit Scope(ProfSection) {}
+  };
 
-  static void flush() {}
+  static void Record(ProfSection, uint32_t) {}
+  static void Update() {}
 };
 
-
-using Log = Logger<CONNECT_TO_PC>;
+// reports go out over Log, so there is nothing to gain without a PC attached
+using Prof = Profiler<PROFILE_TIMING && CONNECT_TO_PC>;
 
 // -----------------------------------------------------------------------------
-// Panic Handler
+// Framing
 // -----------------------------------------------------------------------------
-enum class PanicReason : uint8_t
+// Frame: binary message as it goes on the wire:
+//   0x00, COBS(payload + CRC16), 0x00
+// CRC16/CCITT-FALSE (poly 0x1021, init 0xFFFF) over the payload, little endian.
+// The leading 0x00 puts any text line sent between frames (banner, panic dump)
+// in a chunk of its own: a host splitting on 0x00 shows chunks that fail COBS/CRC
+// as text. Payloads stay below 254 bytes, so COBS always adds exactly one byte.
+
+// CRC16/CCITT-FALSE, shared by frames and everything kept in EEPROM.
+uint16_t Crc16(void const* data, uint8_t const len, uint16_t crc = 0xFFFFU)
 {
-  None = 0,
-  SensorDisconnected,
-  OverMax,
-  DesyncNoRise,
-  LEDRegisterFail,
-  Other
+  uint8_t const* p = static_cast<uint8_t const*>(data);
+  for(uint8_t i{}; i < len; ++i) crc = _crc_xmodem_update(crc, p[i]);
+  return crc;
+}
+
+struct Frame
+{
+  // first payload byte
+  enum Type : uint8_t
+  {
+    STATE = 1U, // Telemetry::SendState
+    TOKEN = 2U, // TokenFrame
+    STATS = 3U, // Telemetry::SendStats
+    HISTORY = 4U // History::Update
+  };
+
+  static constexpr uint8_t MAX_PAYLOAD = 37U;
+  static constexpr uint8_t MAX_SIZE = MAX_PAYLOAD + 2U + 3U; // CRC, COBS code, delimiters
+
+  // Returns the number of bytes written to out (at most MAX_SIZE).
+  static uint8_t Encode(uint8_t const* payload, uint8_t const len, uint8_t* out)
+  {
+    uint8_t raw[MAX_PAYLOAD + 2U];
+    memcpy(raw, payload, len);
+    uint16_t const crc{ Crc16(payload, len) };
+    raw[len] = static_cast<uint8_t>(crc);
+    raw[len + 1U] = static_cast<uint8_t>(crc >> 8);
+
+    out[0] = 0U;
+    uint8_t const n{ CobsEncode(raw, static_cast<uint8_t>(len + 2U), &out[1]) };
+    out[n + 1U] = 0U;
+    return static_cast<uint8_t>(n + 2U);
+  }
+
+private:
+  static uint8_t CobsEncode(uint8_t const* in, uint8_t const len, uint8_t* out)
+  {
+    uint8_t code_at{ 0U };
+    uint8_t code{ 1U };
+    uint8_t o{ 1U };
+    for(uint8_t i{}; i < len; ++i)
+    {
+      if(in[i] == 0U)
+      {
+        out[code_at] = code;
+        code_at = o++;
+        code = 1U;
+      }
+      else
+      {
+        out[o++] = in[i];
+        ++code;
+      }
+    }
+    out[code_at] = code;
+    return o;
+  }
 };
-struct PanicInfo
+
+// -----------------------------------------------------------------------------
+// Fixed point temperature
+// -----------------------------------------------------------------------------
+// Temp16: temperature in 1/16 C, the DS18B20's native 12-bit resolution, so
+// conversions from sensor floats are exact. Log prints it with FormatTemp16: integer
+// ops only, TEMP_DECIMALS digits, rounded, instead of Print's per-digit float maths.
+
+constexpr uint8_t TEMP_DECIMALS{ 2U };
+
+struct Temp16
 {
-  uint32_t ms;
-  uint16_t line;
-  uint8_t  uid;
-  PanicReason reason;
+  int16_t raw;
 };
-const __FlashStringHelper* PanicReasonStr(PanicReason r)
+
+constexpr int16_t TempToRaw(float const temp_c)
 {
-  switch (r)
-  {
-    case PanicReason::SensorDisconnected: return F("SensorDisconnected");
-    case PanicReason::OverMax:            return F("OverMax");
-    case PanicReason::DesyncNoRise:       return F("DesyncNoRise");
-    case PanicReason::LEDRegisterFail:    return F("LEDRegisterFail");
-    case PanicReason::Other:              return F("Other");
-    default:                              return F("None");
-  }
+  return static_cast<int16_t>(temp_c * 16.0f);
 }
-class Panic
+
+constexpr uint16_t Pow10(uint8_t const n)
 {
-public:
-  using Callback = void (*)();
-  static constexpr unsigned char MAX_CALLBACKS = 4U;
+  return n == 0U ? 1U : static_cast<uint16_t>(10U * Pow10(n - 1U));
+}
 
-  template<unsigned int N>
-  static void Init(Callback const (&cbs)[N])
-  {
-    static_assert(N <= MAX_CALLBACKS, "Too many panic callbacks"); // pick capacity
-    callback_count_ = static_cast<uint8_t>(N);
-    for (uint8_t i = 0; i < callback_count_; ++i)
-      callbacks_[i] = cbs[i];
-  }
-  static bool IsPanic()
+// Writes "[-]i.ddd" into out, no terminator; returns the length (at most
+// TEMP16_MAX_CHARS). Fraction is sixteenths scaled to TEMP_DECIMALS and rounded
+// half up, carrying into the integer part.
+constexpr uint8_t TEMP16_MAX_CHARS{ 6U + TEMP_DECIMALS }; // "-2048." + decimals
+
+uint8_t FormatTemp16(int16_t const raw, char* out)
+{
+  static_assert(TEMP_DECIMALS <= 4U, "1/16 C has at most 4 meaningful decimals");
+  constexpr uint16_t SCALE{ Pow10(TEMP_DECIMALS) };
+
+  uint8_t n{};
+  uint16_t mag{ static_cast<uint16_t>(raw) };
+  if(raw < 0)
   {
-    return is_panic_;
+    out[n++] = '-';
+    mag = static_cast<uint16_t>(-static_cast<int32_t>(raw));
   }
 
-  static void StartPanic(PanicReason reason, uint8_t uid, uint16_t line) 
+  uint16_t whole{ static_cast<uint16_t>(mag >> 4) };
+  // 15 * 10000 + 8 still fits 32 bits; with TEMP_DECIMALS <= 2 it would fit 16
+  uint16_t frac{ static_cast<uint16_t>((static_cast<uint32_t>(mag & 0x0FU) * SCALE + 8U) >> 4) };
+  if(frac >= SCALE)
   {
-    if(is_panic_) return;
-
-    is_panic_ = true;
+    frac = static_cast<uint16_t>(frac - SCALE);
+    ++whole;
+  }
 
-    panic_info_.ms = millis();
-    panic_info_.line = line;
-    panic_info_.uid = uid;
-    panic_info_.reason = reason;
-    
+  char digits[5];
+  uint8_t d{};
+  do { digits[d++] = static_cast<char>('0' + whole % 10U); whole /= 10U; } while(whole != 0U);
+  while(d != 0U) out[n++] = digits[--d];
 
-    for (unsigned char i = 0U; i < callback_count_; ++i)
+  if(TEMP_DECIMALS != 0U)
+  {
+    out[n++] = '.';
+    for(uint8_t i{ TEMP_DECIMALS }; i != 0U; --i)
     {
-      if (callbacks_[i])
-      {
-        callbacks_[i]();
-      }
+      out[n + i - 1U] = static_cast<char>('0' + frac % 10U);
+      frac /= 10U;
     }
-    
-    Log::println(F("PANIC START"));
-    PrintPanic();
+    n = static_cast<uint8_t>(n + TEMP_DECIMALS);
   }
-  static void PrintPanic()
+  return n;
+}
+
+// -----------------------------------------------------------------------------
+// Log strings
+// -----------------------------------------------------------------------------
+// LOG_STR("text"): the string type Log takes. It carries a 16-bit token (FNV-1a of
+// the text, folded) computed at compile time and, unless TELEMETRY is Tokenized,
+// the F() flash string. Tokenized builds send only the token and never place the
+// text in flash; tools/logdict.py scans the source for LOG_STR and rebuilds the
+// token -> text dictionary on the host.
+// Another macro, but the literal has to be hashed at compile time and dropped.
+
+struct LogStr
+{
+  uint16_t token;
+  const __FlashStringHelper* text;
+};
+
+constexpr uint32_t LogFnv1a(char const* s, uint32_t const h)
+{
+  return *s ? LogFnv1a(s + 1, (h ^ static_cast<uint8_t>(*s)) * 16777619UL) : h;
+}
+constexpr uint16_t LogTokenOf(char const* s)
+{
+  return static_cast<uint16_t>((LogFnv1a(s, 2166136261UL) >> 16) ^ (LogFnv1a(s, 2166136261UL) & 0xFFFFUL));
+}
+// forces the hash to be a constant so the literal itself is never emitted
+template<uint16_t T>
+struct LogToken
+{
+  static constexpr uint16_t value = T;
+};
+
+#define LOG_STR(s) (LogStr{ LogToken<LogTokenOf(s)>::value, \
+                            (TELEMETRY == TelemetryMode::Tokenized) ? nullptr : F(s) })
+
+// TokenFrame: one Log line in Tokenized mode, as a Frame::TOKEN payload:
+//   u8 type, then items of u8 tag + little endian value (see Tag)
+// A line longer than a frame goes out in parts: every part but the last ends with
+// a MORE tag and every part but the first starts with one, so the decoder joins
+// them and can tell when a part in between was dropped. Add() is false when the
+// item does not fit; room for a DROPPED item and the closing MORE is always kept.
+class TokenFrame
+{
+public:
+  enum Tag : uint8_t
   {
-    if (panic_info_.reason == PanicReason::None)
-    {
-      Log::println(F("Panic: <none>"));
-      return;
-    }
+    TOKEN     = 0x01U, // u16
+    U8        = 0x02U,
+    I16       = 0x03U,
+    U16       = 0x04U,
+    I32       = 0x05U,
+    U32       = 0x06U,
+    FLOAT     = 0x07U, // IEEE754 single
+    CHAR      = 0x08U,
+    DROPPED   = 0x09U, // u16, Log messages lost before this one
+    TEMP16    = 0x0AU, // i16, 1/16 C
+    MORE      = 0x7EU  // no value, see above
+  };
 
-    Log::println(F("Panic (latched):"));
-    Log::print(F("  Reason: ")); Log::println(PanicReasonStr(panic_info_.reason));
-    Log::print(F("  UID: "));    Log::println(panic_info_.uid);
-    Log::print(F("  Line: "));   Log::println(panic_info_.line);
-    Log::print(F("  Millis: ")); Log::println(panic_info_.ms);
+  explicit TokenFrame(uint8_t const type): len_(1U) { buf_[0] = type; }
+
+  bool Add(LogStr const& s)       { return Item(TOKEN, s.token, 2U); }
+  bool Add(Temp16 const& t)       { return Item(TEMP16, static_cast<uint16_t>(t.raw), 2U); }
+  bool Add(char const v)          { return Item(CHAR, static_cast<uint8_t>(v), 1U); }
+  bool Add(unsigned char const v) { return Item(U8, v, 1U); }
+  bool Add(int const v)           { return Item(I16, static_cast<uint16_t>(v), 2U); }
+  bool Add(unsigned int const v)  { return Item(U16, v, 2U); }
+  bool Add(long const v)          { return Item(I32, static_cast<uint32_t>(v), 4U); }
+  bool Add(unsigned long const v) { return Item(U32, v, 4U); }
+  bool Add(double const v)
+  {
+    float const f{ static_cast<float>(v) };
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    return Item(FLOAT, bits, 4U);
   }
+  // these two always fit, see RESERVE
+  void AddDropped(uint16_t const n) { Put(DROPPED, n, 2U); }
+  void AddMore() { Put(MORE, 0U, 0U); }
+
+  bool Empty() const { return len_ <= 1U; }
+  uint8_t const* Data() const { return buf_; }
+  uint8_t Size() const { return len_; }
+  void Clear() { len_ = 1U; }
 
 private:
-  static bool is_panic_;
-  static Callback callbacks_[MAX_CALLBACKS];
-  static uint8_t callback_count_;
-  static PanicInfo panic_info_;
-};
+  static constexpr uint8_t RESERVE = 3U + 1U; // DROPPED, MORE
+  static_assert(2U + 5U + RESERVE <= Frame::MAX_PAYLOAD, "a part must fit type, MORE and the largest item");
 
-//I usually do not like macros but __LINE__ is nice to have
-#define PANIC(uid, reason) Panic::StartPanic((reason), (uid), static_cast<uint16_t>(__LINE__))
+  bool Item(uint8_t const tag, uint32_t const v, uint8_t const n)
+  {
+    if(len_ + 1U + n > Frame::MAX_PAYLOAD - RESERVE) return false;
+    Put(tag, v, n);
+    return true;
+  }
+  void Put(uint8_t const tag, uint32_t const v, uint8_t const n)
+  {
+    buf_[len_++] = tag;
+    for(uint8_t i{}; i < n; ++i) buf_[len_++] = static_cast<uint8_t>(v >> (8U * i));
+  }
 
+  uint8_t buf_[Frame::MAX_PAYLOAD];
+  uint8_t len_;
+};
 
 // -----------------------------------------------------------------------------
-// LED Man
+// Logger
 // -----------------------------------------------------------------------------
-// LEDMan: template-based LED pattern controller.
-// Each template argument is one state (mode).
-// For state i, LED is ON for DurationsMs[i] ms, then OFF for DurationsMs[i] ms, repeating.
-//
-// Example usage:
-//   using HeaterLED = LEDMan<10000UL, 1000UL, 50UL>;
-//   // index 0: slow blink (10 s on, 10 s off)
-//   // index 1: fast blink (1 s on, 1 s off)
-//   // index 2: rapid blink (50 ms on, 50 ms off)
 
-// LEDMan: each template argument is one logical LED state (mode).
-// For state i, LED is ON for DurationsMs[i] ms, then OFF for DurationsMs[i] ms, repeat.
-//
-// Public API:
-//   LEDMan<...>::SetState(stateIndex);   // 0 <= stateIndex < N; else Panic::StartPanic()
-//   LEDMan<...>::Update();               // call regularly from loop() to advance timing and drive LED
-//
-// Assumes:
-//   - Arduino environment (millis(), digitalWrite, LED_BUILTIN, HIGH/LOW).
-//   - Panic::StartPanic() exists for error handling.
 
+// TxRing: fixed buffer between Log and the UART so logging never waits on the
+// 64-byte hardware TX buffer. Bytes are staged until '\n' and only committed then,
+// so a message (one line) goes out whole or not at all. A message that does not
+// fit is dropped and counted, and the next one that does get through is prefixed
+// with "[dropped N] ".
+// Pump() only hands Serial as many bytes as availableForWrite() says it can take;
+// it runs on every commit and from loop().
+class TxRing : public Print
+{
+public:
+  static constexpr uint8_t SIZE = 128U; // power of two, at most 128 (uint8_t indices)
 
-//fwd declaration
-class TempController;
+  TxRing():
+    buf_(),
+    head_(0U),
+    tail_(0U),
+    stage_(0U),
+    dropped_(0U),
+    dropping_(false),
+    noted_(false)
+  {}
 
+  using Print::write;
 
-class LEDMan
-{
-private:
-  static constexpr unsigned int MAX_CONTROLLERS = 4U;
-public:
-  static void Register(TempController const * tc)
+  size_t write(uint8_t const c) override
   {
-    if(tc == nullptr || num_controllers_ >= MAX_CONTROLLERS)
+    if(dropping_)
     {
-      PANIC(0, PanicReason::LEDRegisterFail);
-      return;
+      if(c == '\n') dropping_ = false;
+      return 1U;
     }
-    controllers_[num_controllers_++] = tc;
+
+    bool const starting{ stage_ == head_ };
+    if((starting && dropped_ != 0U && !StageDropNote()) || !Stage(c))
+    {
+      Drop(c);
+      return 1U;
+    }
+
+    if(c == '\n')
+    {
+      head_ = stage_;
+      if(noted_) dropped_ = 0U;
+      noted_ = false;
+      Pump(); // free space early; never waits
+    }
+    return 1U;
   }
-  static unsigned long HalfPeriodForState(unsigned int const state)
+
+  // Queue a complete binary message, all or nothing. Only between text lines;
+  // a frame never gets a drop note, callers carry Dropped() in-band instead.
+  bool Push(uint8_t const* data, uint8_t const len)
   {
-    switch(state)
+    if(stage_ != head_ || static_cast<uint8_t>(SIZE - static_cast<uint8_t>(head_ - tail_)) < len)
     {
-      case 0U: return 50UL;
-      case 1U: return 1000UL;
-      default: return 10000UL;
+      if(dropped_ != 0xFFFFU) ++dropped_;
+      return false;
     }
+    for(uint8_t i{}; i < len; ++i)
+    {
+      buf_[stage_ & MASK] = data[i];
+      ++stage_;
+    }
+    head_ = stage_;
+    dropped_ = 0U;
+    Pump();
+    return true;
   }
 
-  static void UpdateState();
+  uint16_t Dropped() const { return dropped_; }
+  uint8_t Free() const { return static_cast<uint8_t>(SIZE - static_cast<uint8_t>(stage_ - tail_)); }
 
-  // Advance timing in the current state and drive the LED.
-  static void Update()
+  // Move committed bytes to the UART without ever blocking.
+  void Pump()
   {
-    UpdateState();
-    const unsigned long now     = millis();
-    const unsigned long elapsed = now - lastToggleMs_;
-
-    const unsigned long halfPeriod = HalfPeriodForState(currentStateIndex_);
-
-    if (elapsed >= halfPeriod)
+    uint8_t pending{ static_cast<uint8_t>(head_ - tail_) };
+    int room{ Serial.availableForWrite() };
+    while(pending != 0U && room > 0)
     {
-      ledOn_ = !ledOn_;
-      lastToggleMs_ = now;
+      Serial.write(buf_[tail_ & MASK]);
+      ++tail_;
+      --pending;
+      --room;
     }
+  }
 
-    digitalWrite(LED_BUILTIN, ledOn_ ? HIGH : LOW);
+  // Blocking: only for places that must get everything out (e.g. before a reset).
+  void Drain()
+  {
+    while(head_ != tail_) Pump();
   }
 
 private:
+  static constexpr uint8_t MASK = SIZE - 1U;
+  static_assert((SIZE & MASK) == 0U && SIZE <= 128U, "TxRing SIZE must be a power of two <= 128");
 
-    static TempController const * controllers_[MAX_CONTROLLERS];
-    static unsigned int num_controllers_;
+  bool Stage(uint8_t const c)
+  {
+    if(static_cast<uint8_t>(stage_ - tail_) >= SIZE) return false;
+    buf_[stage_ & MASK] = c;
+    ++stage_;
+    return true;
+  }
 
-    // Current state index, LED phase, and last toggle time
-    static unsigned int    currentStateIndex_;
-    static bool          ledOn_;
-    static unsigned long lastToggleMs_;
+  bool StageDropNote()
+  {
+    char digits[6];
+    uint8_t n{};
+    uint16_t v{ dropped_ };
+    do { digits[n++] = static_cast<char>('0' + v % 10U); v /= 10U; } while(v != 0U);
+
+    static char const head[] = "[dropped ";
+    for(uint8_t i{}; i < sizeof(head) - 1U; ++i)
+    {
+      if(!Stage(static_cast<uint8_t>(head[i]))) return false;
+    }
+    while(n != 0U)
+    {
+      if(!Stage(static_cast<uint8_t>(digits[--n]))) return false;
+    }
+    if(!Stage(']') || !Stage(' ')) return false;
+
+    noted_ = true;
+    return true;
+  }
+
+  void Drop(uint8_t const c)
+  {
+    stage_ = head_;
+    noted_ = false;
+    if(dropped_ != 0xFFFFU) ++dropped_;
+    dropping_ = (c != '\n');
+  }
+
+  uint8_t buf_[SIZE];
+  uint8_t head_;   // end of committed bytes
+  uint8_t tail_;   // next byte to the UART
+  uint8_t stage_;  // end of the message being built
+  uint16_t dropped_;
+  bool dropping_;  // rest of the current message is being discarded
+  bool noted_;     // current message carries the drop note
 };
-// -----------------------------------------------------------------------------
-// Temp Controller
-// -----------------------------------------------------------------------------
 
-class TempController
+template<bool PC_CON>
+struct Logger;
+
+template<>
+struct Logger<true>
+{
+  static void begin(unsigned long baud)
+  {
+    Serial.begin(baud);
+    // while(!Serial);
+  }
+
+  template<typename... T>
+  static void print(T const&... v)
+  {
+    Prof::Scope const scope{ ProfSection::LogPrint };
+    //janky code expansion due to being on c++11
+    int const dummy[] = { 0, ((void)Put(v), 0)... };
+    (void)dummy;
+  }
+
+  template<typename... T>
+  static void println(T const&... v)
+  {
+    print(v...);
+    if(TOKENIZED)
+    {
+      SendTokens();
+      return;
+    }
+    Ring().println();
+  }
+
+  // binary message, queued whole or dropped whole
+  static bool write(uint8_t const* data, uint8_t const len) { return Ring().Push(data, len); }
+  static uint16_t dropped() { return Ring().Dropped(); }
+  // bytes that can still be queued right now
+  static uint8_t room() { return Ring().Free(); }
+
+  // call regularly from loop() to move queued output to the UART
+  static void pump() { Ring().Pump(); }
+
+  // Runtime LogSys mask for LogAt, bit per LogSys.
+  static bool sys_enabled(uint8_t const bit) { return (sys_mask_ & bit) != 0U; }
+  static uint8_t sys_mask() { return sys_mask_; }
+  static void set_sys_mask(uint8_t const mask) { sys_mask_ = mask; }
+
+  static void flush()
+  {
+    Ring().Drain();
+    Serial.flush();
+  }
+
+private:
+  static constexpr bool TOKENIZED = TELEMETRY == TelemetryMode::Tokenized;
+
+  static void Put(LogStr const& s)
+  {
+    if(TOKENIZED) PutToken(s);
+    else          Ring().print(s.text);
+  }
+  static void Put(Temp16 const& t)
+  {
+    if(TOKENIZED)
+    {
+      PutToken(t);
+      return;
+    }
+    char buf[TEMP16_MAX_CHARS];
+    Ring().write(reinterpret_cast<uint8_t const*>(buf), FormatTemp16(t.raw, buf));
+  }
+  template<typename T>
+  static void Put(T const& v)
+  {
+    if(TOKENIZED) PutToken(v);
+    else          Ring().print(v);
+  }
+  // a full frame goes out as a part of the line and the line carries on in the next
+  template<typename T>
+  static void PutToken(T const& v)
+  {
+    TokenFrame& tf = Tokens();
+    if(tf.Add(v)) return;
+    tf.AddMore();
+    SendTokens();
+    tf.AddMore();
+    tf.Add(v);
+  }
+
+  static void SendTokens()
+  {
+    TokenFrame& tf = Tokens();
+    uint16_t const dropped{ Ring().Dropped() };
+    if(dropped != 0U) tf.AddDropped(dropped);
+
+    uint8_t frame[Frame::MAX_SIZE];
+    Ring().Push(frame, Frame::Encode(tf.Data(), tf.Size(), frame));
+    tf.Clear();
+  }
+
+  // function-local so the buffers only exist in builds that use them
+  static TxRing& Ring()
+  {
+    static TxRing ring;
+    return ring;
+  }
+  static TokenFrame& Tokens()
+  {
+    static TokenFrame frame{ Frame::TOKEN };
+    return frame;
+  }
+
+  static uint8_t sys_mask_;
+};
+
+template<>
+struct Logger<false>
+{
+  static void begin(unsigned long) {}
+  
+  template<typename... T>
+  static void print(T const&...) {}
+
+  template<typename... T>
+  static void println(T const&...) {}
+
+  static bool write(uint8_t const*, uint8_t) { return false; }
+  static uint16_t dropped() { return 0U; }
+  static uint8_t room() { return 0U; }
+
+  static void pump() {}
+
+  static bool sys_enabled(uint8_t) { return false; }
+  static uint8_t sys_mask() { return 0U; }
+  static void set_sys_mask(uint8_t) {}
+
+  static void flush() {}
+};
+
+
+using Log = Logger<CONNECT_TO_PC>;
+
+// LogAt<Sys, Level>: Log for one subsystem at one level. Filtered out at compile
+// time it is Logger<false> and every call vanishes; otherwise each call checks the
+// runtime mask first. Keep a print/println line within one LogAt so it is never
+// half muted.
+template<bool COMPILED, uint8_t SYS_BIT>
+struct FilteredLogger : Logger<false>
+{
+  static constexpr bool enabled() { return false; }
+};
+
+template<uint8_t SYS_BIT>
+struct FilteredLogger<true, SYS_BIT>
+{
+  static bool enabled() { return Logger<true>::sys_enabled(SYS_BIT); }
+
+  template<typename... T>
+  static void print(T const&... v)
+  {
+    if(enabled()) Logger<true>::print(v...);
+  }
+
+  template<typename... T>
+  static void println(T const&... v)
+  {
+    if(enabled()) Logger<true>::println(v...);
+  }
+};
+
+constexpr uint8_t LogSysBit(LogSys const sys)
+{
+  return static_cast<uint8_t>(1U << static_cast<uint8_t>(sys));
+}
+
+template<LogSys SYS, LogLevel LEVEL>
+using LogAt = FilteredLogger<CONNECT_TO_PC && LEVEL <= LOG_LEVEL && (LOG_SYSTEMS & LogSysBit(SYS)) != 0U,
+                             LogSysBit(SYS)>;
+
+using PanicLog  = LogAt<LogSys::Panic,   LogLevel::Error>;
+using SensorLog = LogAt<LogSys::Sensor,  LogLevel::Warn>;
+using CtrlLog   = LogAt<LogSys::Control, LogLevel::Info>;
+using SysLog    = LogAt<LogSys::System,  LogLevel::Info>;
+using LedLog    = LogAt<LogSys::LED,     LogLevel::Debug>;
+
+// -----------------------------------------------------------------------------
+// Memory
+// -----------------------------------------------------------------------------
+// Memory: how close the stack has ever come to the static data. Nothing here uses
+// the heap, so all RAM from the end of .bss (_end) up to the top (__stack) is stack
+// or free. PaintStack() fills it with CANARY from .init3, before any C code runs
+// (r1 is zero and SP is at the top there, and nothing has been pushed yet);
+// Margin() then counts the painted bytes the stack has never reached, i.e. the
+// free RAM low-water mark since reset. The scan walks at most that gap, well under
+// a millisecond on the Uno, so Update() does it every MEM_CHECK_MS.
+
+extern uint8_t _end;
+extern uint8_t __stack;
+
+class Memory
+{
+public:
+  static constexpr uint8_t CANARY = 0xC5U;
+
+  // free RAM low-water mark since reset, bytes
+  static uint16_t Margin()
+  {
+    uint8_t const* p{ &_end };
+    while(p <= &__stack && *p == CANARY) ++p;
+    return static_cast<uint16_t>(p - &_end);
+  }
+  // free RAM right now: between the end of .bss and this frame
+  static uint16_t FreeNow()
+  {
+    uint8_t here{};
+    return static_cast<uint16_t>(&here - &_end);
+  }
+
+  static void Update()
+  {
+    unsigned long const now{ millis() };
+    if(now - last_check_ms_ < MEM_CHECK_MS) return;
+    last_check_ms_ = now;
+
+    uint16_t const margin{ Margin() };
+    if(margin < MEM_WARN_BYTES && !warned_)
+    {
+      warned_ = true;
+      SysLog::println(LOG_STR("MEM: low, stack came within "), margin, LOG_STR(" bytes"));
+    }
+  }
+  static void Print()
+  {
+    SysLog::println(LOG_STR("MEM: free "), FreeNow(), LOG_STR(", low-water "), Margin(),
+                    LOG_STR(" of "), static_cast<uint16_t>(&__stack - &_end + 1));
+  }
+
+private:
+  static unsigned long last_check_ms_;
+  static bool warned_;
+};
+
+// Basic asm only: a naked function has no frame, so compiled C in it is not safe.
+// Z walks _end..__stack inclusive.
+#if defined(__AVR__)
+void PaintStack() __attribute__((naked, used, section(".init3")));
+void PaintStack()
+{
+  __asm__ __volatile__(
+    "    ldi r30, lo8(_end)\n"
+    "    ldi r31, hi8(_end)\n"
+    "    ldi r24, 0xC5\n"
+    "    ldi r25, hi8(__stack)\n"
+    "    rjmp 2f\n"
+    "1:  st Z+, r24\n"
+    "2:  cpi r30, lo8(__stack)\n"
+    "    cpc r31, r25\n"
+    "    brlo 1b\n"
+    "    breq 1b\n");
+}
+#endif
+static_assert(Memory::CANARY == 0xC5U, "PaintStack() paints 0xC5");
+
+// -----------------------------------------------------------------------------
+// Fast Pin
+// -----------------------------------------------------------------------------
+// FastPin<Pin>: compile-time pin that maps an Uno pin number straight onto its
+// PORTx/DDRx bit, so every call folds down to a single sbi/cbi.
+// digitalWrite looks the port and mask up from flash tables at runtime and has to
+// guard its read-modify-write with cli; sbi/cbi is atomic on its own.
+//
+//   pins 0..7   -> PORTD bit 0..7
+//   pins 8..13  -> PORTB bit 0..5
+//   pins 14..19 -> PORTC bit 0..5 (A0..A5)
+template<uint8_t Pin>
+struct FastPin
+{
+  static_assert(Pin < 20U, "FastPin only maps the Uno pins 0..19");
+
+  static constexpr uint8_t BIT  = Pin < 8U ? Pin : (Pin < 14U ? Pin - 8U : Pin - 14U);
+  static constexpr uint8_t MASK = static_cast<uint8_t>(1U << BIT);
+
+  static volatile uint8_t& Port() { return Pin < 8U ? PORTD : (Pin < 14U ? PORTB : PORTC); }
+  static volatile uint8_t& Ddr()  { return Pin < 8U ? DDRD  : (Pin < 14U ? DDRB  : DDRC);  }
+  static volatile uint8_t& In()   { return Pin < 8U ? PIND  : (Pin < 14U ? PINB  : PINC);  }
+
+  static void Output() { Ddr() |= MASK; }
+  static void High()   { Port() |= MASK; }
+  static void Low()    { Port() &= static_cast<uint8_t>(~MASK); }
+  static void Write(uint8_t const level) { if(level == LOW) Low(); else High(); }
+};
+
+// Type-erased handle so the Supervisor can drive every zone's relay through
+// FastPin from one slot table.
+using PinDrive = void (*)(uint8_t level);
+
+template<uint8_t Pin>
+struct PinDriver
+{
+  // Level first, then direction, so the pin never glitches to the wrong state
+  // when it is first made an output. Re-asserting DDR is one cycle and keeps the
+  // relay pin an output no matter what else touched it.
+  static void Drive(uint8_t const level)
+  {
+    FastPin<Pin>::Write(level);
+    FastPin<Pin>::Output();
+  }
+};
+
+// PinGroup<Pins...>: a set of FastPins written together with one read-modify-write
+// per port that actually holds one of them; ports without a member pin fold away.
+template<uint8_t... Pins>
+struct PortMasks;
+
+template<>
+struct PortMasks<>
+{
+  static constexpr uint8_t B = 0U;
+  static constexpr uint8_t C = 0U;
+  static constexpr uint8_t D = 0U;
+};
+
+template<uint8_t Pin, uint8_t... Rest>
+struct PortMasks<Pin, Rest...>
+{
+  static constexpr uint8_t B = PortMasks<Rest...>::B | ((Pin >= 8U && Pin < 14U) ? FastPin<Pin>::MASK : 0U);
+  static constexpr uint8_t C = PortMasks<Rest...>::C | (Pin >= 14U ? FastPin<Pin>::MASK : 0U);
+  static constexpr uint8_t D = PortMasks<Rest...>::D | (Pin < 8U ? FastPin<Pin>::MASK : 0U);
+};
+
+template<uint8_t... Pins>
+struct PinGroup
+{
+  using Masks = PortMasks<Pins...>;
+
+  // Not atomic across ports; callers that race ISRs wrap it in ATOMIC_BLOCK.
+  static void Write(uint8_t const level)
+  {
+    Apply(PORTB, Masks::B, level);
+    Apply(PORTC, Masks::C, level);
+    Apply(PORTD, Masks::D, level);
+  }
+
+private:
+  static void Apply(volatile uint8_t& port, uint8_t const mask, uint8_t const level)
+  {
+    if(mask == 0U) return;
+    port = (level == LOW) ? static_cast<uint8_t>(port & ~mask) : static_cast<uint8_t>(port | mask);
+  }
+};
+
+// IndexSeq<0..N-1> (C++11 has no std::index_sequence), to expand the zone table
+template<uint8_t... I>
+struct IndexSeq {};
+
+template<uint8_t N, uint8_t... I>
+struct MakeIndexSeq : MakeIndexSeq<N - 1U, N - 1U, I...> {};
+
+template<uint8_t... I>
+struct MakeIndexSeq<0U, I...>
+{
+  using Type = IndexSeq<I...>;
+};
+
+using ZoneIndices = MakeIndexSeq<ZONE_COUNT>::Type;
+
+template<typename Seq>
+struct ZoneRelayPins;
+
+template<uint8_t... I>
+struct ZoneRelayPins<IndexSeq<I...>>
+{
+  using Type = PinGroup<ZONES[I].relay_pin...>;
+};
+
+using AllRelayPins = ZoneRelayPins<ZoneIndices>::Type;
+
+// -----------------------------------------------------------------------------
+// Panic Handler
+// -----------------------------------------------------------------------------
+enum class PanicReason : uint8_t
+{
+  None = 0,
+  SensorDisconnected,
+  OverMax,
+  DesyncNoRise,
+  LEDRegisterFail,    // no longer raised (zones are wired at compile time); kept so journal counts stay put
+  SupervisorTrip,
+  Watchdog,
+  Other,
+  ProbeDisagree // new reasons go last so journaled values stay put; see PANIC_REASON_COUNT
+};
+constexpr uint8_t PANIC_REASON_COUNT{ static_cast<uint8_t>(PanicReason::ProbeDisagree) + 1U };
+struct PanicInfo
+{
+  uint32_t ms;
+  uint16_t line;
+  uint8_t  uid;
+  PanicReason reason;
+  uint16_t latency_us; // sample -> relays off, sample-driven reasons only
+  int16_t  temp_raw;   // Temp16 of that sample, sample-driven reasons only
+};
+static_assert(sizeof(PanicInfo) == 12U, "PanicInfo is stored in the journal: bump Journal::VERSION with it");
+LogStr PanicReasonStr(PanicReason r)
+{
+  switch (r)
+  {
+    case PanicReason::SensorDisconnected: return LOG_STR("SensorDisconnected");
+    case PanicReason::OverMax:            return LOG_STR("OverMax");
+    case PanicReason::DesyncNoRise:       return LOG_STR("DesyncNoRise");
+    case PanicReason::LEDRegisterFail:    return LOG_STR("LEDRegisterFail");
+    case PanicReason::SupervisorTrip:     return LOG_STR("SupervisorTrip");
+    case PanicReason::Watchdog:           return LOG_STR("Watchdog");
+    case PanicReason::Other:              return LOG_STR("Other");
+    case PanicReason::ProbeDisagree:      return LOG_STR("ProbeDisagree");
+    default:                              return LOG_STR("None");
+  }
+}
+// -----------------------------------------------------------------------------
+// Panic Journal
+// -----------------------------------------------------------------------------
+// Journal: the last SLOTS PanicInfo records plus running per-reason counters, kept
+// in EEPROM so a reset or brownout does not lose why the heaters went off.
+// One Record per panic, round robin over the slots (wear leveling: each slot takes
+// one write per SLOTS panics). Every record carries the counters as of that panic,
+// so the counters live in the newest valid record and are spread over the slots too.
+// Records carry a sequence number and a CRC; blank or torn slots are skipped.
+//
+// Writing takes ~3.3 ms per changed byte and blocks, which is fine for a once per
+// panic write that happens after the relays are already off.
+// Dump() queues a report that Update() emits one line at a time, only when the Log
+// ring has room, so asking for it never stalls the control loop.
+
+class Journal
+{
+public:
+  static constexpr uint8_t SLOTS = 8U;
+  static constexpr uint8_t REASONS = 12U; // room for new PanicReasons without a layout change
+
+  // Call once in setup() before anything can panic.
+  static void Load()
+  {
+    valid_ = 0U;
+    for(uint8_t i{}; i < SLOTS; ++i)
+    {
+      Record r;
+      if(!Read(i, r)) continue;
+      if(valid_ == 0U || static_cast<int16_t>(r.seq - newest_seq_) > 0)
+      {
+        newest_seq_ = r.seq;
+        newest_slot_ = i;
+        memcpy(counts_, r.counts, sizeof(counts_));
+      }
+      ++valid_;
+    }
+    if(valid_ == 0U)
+    {
+      newest_seq_ = 0U;
+      newest_slot_ = SLOTS - 1U;
+      memset(counts_, 0, sizeof(counts_));
+    }
+  }
+
+  static void Append(PanicInfo const& info)
+  {
+    uint8_t const reason{ static_cast<uint8_t>(info.reason) };
+    if(reason < REASONS && counts_[reason] != 0xFFU) ++counts_[reason];
+
+    Record r;
+    r.version = VERSION;
+    r.seq = static_cast<uint16_t>(newest_seq_ + 1U);
+    r.info = info;
+    memcpy(r.counts, counts_, sizeof(counts_));
+    r.crc = Crc16(&r, CRC_LEN);
+
+    newest_slot_ = static_cast<uint8_t>((newest_slot_ + 1U) % SLOTS);
+    newest_seq_ = r.seq;
+    if(valid_ < SLOTS) ++valid_;
+    EEPROM.put(SlotAddr(newest_slot_), r);
+  }
+
+  static void Dump() { cursor_ = 1U; }
+
+  // Call regularly from loop(); emits at most one line of a pending Dump().
+  static void Update()
+  {
+    if(cursor_ == 0U) return;
+    if(!PanicLog::enabled())
+    {
+      cursor_ = 0U;
+      return;
+    }
+    if(Log::room() < LINE_ROOM) return;
+
+    if(cursor_ == 1U)
+    {
+      PanicLog::print(LOG_STR("JRNL: "), valid_, LOG_STR(" records, counts"));
+      for(uint8_t i{ 1U }; i < PANIC_REASON_COUNT; ++i) PanicLog::print(' ', counts_[i]);
+      PanicLog::println();
+      ++cursor_;
+      return;
+    }
+
+    // records oldest first
+    uint8_t const k{ static_cast<uint8_t>(cursor_ - 2U) };
+    if(k >= valid_)
+    {
+      cursor_ = 0U;
+      return;
+    }
+    ++cursor_;
+    uint8_t const slot{ static_cast<uint8_t>((newest_slot_ + SLOTS - (valid_ - 1U - k)) % SLOTS) };
+    Record r;
+    if(!Read(slot, r)) return;
+    PanicLog::print(LOG_STR("JRNL: #"), r.seq, ' ', PanicReasonStr(r.info.reason),
+                    LOG_STR(" uid="), r.info.uid, LOG_STR(" line="), r.info.line);
+    PanicLog::println(LOG_STR(" ms="), r.info.ms, LOG_STR(" temp="), Temp16{ r.info.temp_raw },
+                      LOG_STR(" lat="), r.info.latency_us);
+  }
+
+private:
+  static constexpr uint8_t VERSION = 1U;
+  static constexpr uint8_t LINE_ROOM = 96U;
+  static_assert(PANIC_REASON_COUNT <= REASONS, "Journal::REASONS too small; bump VERSION with it");
+
+  struct Record
+  {
+    uint8_t version;
+    uint16_t seq;
+    PanicInfo info;
+    uint8_t counts[REASONS]; // by PanicReason, saturating
+    uint16_t crc;            // over everything above
+  };
+  static constexpr uint8_t CRC_LEN = offsetof(Record, crc);
+  static_assert(SLOTS * sizeof(Record) <= EE_JOURNAL_SIZE, "Journal does not fit its EEPROM region");
+
+  static uint16_t SlotAddr(uint8_t const slot)
+  {
+    return static_cast<uint16_t>(EE_JOURNAL_BASE + slot * sizeof(Record));
+  }
+  static bool Read(uint8_t const slot, Record& r)
+  {
+    EEPROM.get(SlotAddr(slot), r);
+    return r.version == VERSION && r.crc == Crc16(&r, CRC_LEN);
+  }
+
+  static uint8_t counts_[REASONS];
+  static uint16_t newest_seq_;
+  static uint8_t newest_slot_;
+  static uint8_t valid_;
+  static uint8_t cursor_; // 0 idle, 1 header, 2.. records
+};
+
+class Panic
+{
+public:
+  using Callback = void (*)();
+  static constexpr unsigned char MAX_CALLBACKS = ZONE_COUNT;
+
+  template<unsigned int N>
+  static void Init(Callback const (&cbs)[N])
+  {
+    static_assert(N <= MAX_CALLBACKS, "Too many panic callbacks"); // pick capacity
+    callback_count_ = static_cast<uint8_t>(N);
+    for (uint8_t i = 0; i < callback_count_; ++i)
+      callbacks_[i] = cbs[i];
+  }
+  static bool IsPanic()
+  {
+    return is_panic_;
+  }
+  // Only the zone that raised it goes off, see TempController::Fault().
+  static bool IsZoneScoped(PanicReason const r)
+  {
+    return ZONE_FAULTS && (r == PanicReason::SensorDisconnected || r == PanicReason::DesyncNoRise ||
+                           r == PanicReason::ProbeDisagree || (OVERMAX_ZONE_FAULT && r == PanicReason::OverMax));
+  }
+
+  // Timestamp a fresh sample so a panic raised while handling it can report the
+  // temperature and how long it took from the sample to every relay being off.
+  static void MarkSample(int16_t const raw)
+  {
+    sample_us_ = micros();
+    sample_raw_ = raw;
+  }
+
+  static void StartPanic(PanicReason reason, uint8_t uid, uint16_t line) 
+  {
+    // Relays go off before anything else, latched or not: one port write for all
+    // of them, no callback dispatch, no digitalWrite. Everything below is bookkeeping.
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+      AllRelayPins::Write(RELAY_INACTIVE_STATE);
+    }
+    uint32_t const off_us{ micros() };
+
+    if(is_panic_)
+    {
+      // count it; only a different reason or zone is news worth a heartbeat soon
+      if(repeats_ < 0xFFU) ++repeats_;
+      if(reason != panic_info_.reason || uid != panic_info_.uid) BackOffReset();
+      return;
+    }
+
+    is_panic_ = true;
+
+    panic_info_ = Describe(reason, uid, line, off_us);
+    Journal::Append(panic_info_);
+
+    // keeps each controller's own state (st_ = OFF, heater_is_off_) in line
+
+    for (unsigned char i = 0U; i < callback_count_; ++i)
+    {
+      if (callbacks_[i])
+      {
+        callbacks_[i]();
+      }
+    }
+    
+    PanicLog::println(LOG_STR("PANIC START"));
+    PrintPanic();
+    BackOffReset();
+  }
+
+  // A zone scoped fault: the zone has switched its own relay off already and
+  // stays off by itself; here it is only journaled and reported. Nothing latches.
+  // A repeat (non-zero: how many so far) of a flapping fault is reported only.
+  static void ZoneFault(PanicReason const reason, uint8_t const uid, uint16_t const line, uint8_t const repeat)
+  {
+    uint32_t const off_us{ micros() };
+    if(repeat == 0U) Journal::Append(Describe(reason, uid, line, off_us));
+    PanicLog::print(LOG_STR("FAULT ")); PanicLog::print(PanicReasonStr(reason));
+    PanicLog::print(LOG_STR(" uid ")); PanicLog::print(uid);
+    if(repeat != 0U) PanicLog::print(LOG_STR(" repeat "), repeat);
+    PanicLog::println();
+  }
+
+  // Call every loop(). While latched sends the heartbeat when due and a full
+  // record after RequestReport().
+  static void Report()
+  {
+    if(!is_panic_) return;
+    if(full_requested_)
+    {
+      full_requested_ = false;
+      PrintPanic();
+    }
+
+    uint32_t const now{ millis() };
+    if(now - last_report_ms_ < report_interval_ms_) return;
+    last_report_ms_ = now;
+    if(report_interval_ms_ < PANIC_REPORT_MAX_MS / 2UL) report_interval_ms_ *= 2UL;
+    else report_interval_ms_ = PANIC_REPORT_MAX_MS;
+
+    PanicLog::print(LOG_STR("PANIC ")); PanicLog::print(PanicReasonStr(panic_info_.reason));
+    PanicLog::print(LOG_STR(" uid ")); PanicLog::print(panic_info_.uid);
+    PanicLog::print(LOG_STR(" for ")); PanicLog::print((now - panic_info_.ms) / 1000UL);
+    PanicLog::print(LOG_STR(" s"));
+    if(repeats_ != 0U)
+    {
+      PanicLog::print(LOG_STR(", ")); PanicLog::print(repeats_); PanicLog::print(LOG_STR(" more"));
+    }
+    PanicLog::println();
+  }
+  static void RequestReport()
+  {
+    full_requested_ = true;
+  }
+  static void PrintPanic()
+  {
+    if (panic_info_.reason == PanicReason::None)
+    {
+      PanicLog::println(LOG_STR("Panic: <none>"));
+      return;
+    }
+
+    PanicLog::println(LOG_STR("Panic (latched):"));
+    PanicLog::print(LOG_STR("  Reason: ")); PanicLog::println(PanicReasonStr(panic_info_.reason));
+    PanicLog::print(LOG_STR("  UID: "));    PanicLog::println(panic_info_.uid);
+    PanicLog::print(LOG_STR("  Line: "));   PanicLog::println(panic_info_.line);
+    PanicLog::print(LOG_STR("  Millis: ")); PanicLog::println(panic_info_.ms);
+    if(IsSampleDriven(panic_info_.reason))
+    {
+      PanicLog::print(LOG_STR("  Temp: "));    PanicLog::print(Temp16{ panic_info_.temp_raw }); PanicLog::println(LOG_STR(" C"));
+      PanicLog::print(LOG_STR("  Latency: ")); PanicLog::print(panic_info_.latency_us); PanicLog::println(LOG_STR(" us"));
+    }
+  }
+
+private:
+  // raised from TempController::Update() right after MarkSample()
+  static bool IsSampleDriven(PanicReason const r)
+  {
+    return r == PanicReason::OverMax || r == PanicReason::DesyncNoRise;
+  }
+  static PanicInfo Describe(PanicReason const reason, uint8_t const uid, uint16_t const line, uint32_t const off_us)
+  {
+    PanicInfo info{ millis(), line, uid, reason, 0U, 0 };
+    if(IsSampleDriven(reason))
+    {
+      info.temp_raw = sample_raw_;
+      uint32_t const dt{ off_us - sample_us_ };
+      info.latency_us = dt > 0xFFFFUL ? 0xFFFFU : static_cast<uint16_t>(dt);
+    }
+    return info;
+  }
+  static void BackOffReset()
+  {
+    last_report_ms_ = millis();
+    report_interval_ms_ = PANIC_REPORT_MIN_MS;
+  }
+
+  static bool is_panic_;
+  static Callback callbacks_[MAX_CALLBACKS];
+  static uint8_t callback_count_;
+  static PanicInfo panic_info_;
+  static uint32_t sample_us_;
+  static int16_t sample_raw_;
+  static uint32_t last_report_ms_;
+  static uint32_t report_interval_ms_;
+  static uint8_t repeats_; // StartPanic() calls after the latch, saturating
+  static bool full_requested_;
+};
+
+//I usually do not like macros but __LINE__ is nice to have
+#define PANIC(uid, reason) Panic::StartPanic((reason), (uid), static_cast<uint16_t>(__LINE__))
+
+// -----------------------------------------------------------------------------
+// Config
+// -----------------------------------------------------------------------------
+// Config: the tunables that can change without a reflash. The live copy is in RAM;
+// EE_CONFIG_BASE holds a versioned, CRC-protected copy of it.
+// Load() takes the EEPROM copy only if version, zone count, CRC and every range
+// check pass, otherwise the compiled defaults (ZONES, TEMP_ALLOWANCE, DESYNC_*,
+// READ_INTERVAL_MS). Changes apply at once but are written back only after
+// CONFIG_COMMIT_DELAY_MS without another change, through EEPROM.put() (which only
+// rewrites bytes that differ), so a tuning session costs one write.
+// A zone's max can only be lowered: ZONES[i].max_c is the ceiling the Supervisor
+// enforces no matter what is stored here.
+
+struct ZoneSettings
+{
+  int16_t target_raw;   // Temp16
+  int16_t max_raw;      // Temp16, <= ZONES[i].max_c
+  uint8_t hyst_raw;     // Temp16, +/- band around the target
+  uint8_t rise_raw;     // DesyncMan: Temp16 rise needed ...
+  uint16_t rise_wait_s; // ... within this long of heating
+};
+static_assert(sizeof(ZoneSettings) == 8U, "ZoneSettings is stored in EEPROM: bump Config::VERSION with it");
+
+class Config
+{
+public:
+  enum class Key : uint8_t { Target, Max, Hyst, Rise, RiseWait };
+
+  static constexpr uint8_t HYST_MIN_RAW = 1U;        // 1/16 C
+  static constexpr uint8_t HYST_MAX_RAW = 32U;       // 2 C
+  static constexpr uint8_t RISE_MIN_RAW = 1U;
+  static constexpr uint8_t RISE_MAX_RAW = 64U;       // 4 C
+  static constexpr uint16_t RISE_WAIT_MIN_S = 60U;
+  static constexpr uint16_t RISE_WAIT_MAX_S = 3600U;
+
+  // static_assert'ed per zone by TempController<I>
+  template<uint8_t I>
+  static constexpr bool DefaultValid()
+  {
+    return ZoneValid(DefaultZone<I>(), TempToRaw(ZONES[I].max_c));
+  }
+
+  static void Load()
+  {
+    Record r;
+    EEPROM.get(EE_CONFIG_BASE, r);
+    from_eeprom_ = Valid(r);
+    if(from_eeprom_) rec_ = r;
+    else Defaults(rec_, ZoneIndices{});
+    dirty_ = false;
+  }
+
+  static ZoneSettings const& Zone(uint8_t const i) { return rec_.zone[i]; }
+  static unsigned long ReadIntervalMs() { return rec_.read_interval_ms; }
+
+  // ceiling_raw: ZONES[i].max_c as Temp16. False (and unchanged) when out of range.
+  static bool SetZone(uint8_t const i, int16_t const ceiling_raw, Key const key, int16_t const v)
+  {
+    ZoneSettings z{ rec_.zone[i] };
+    switch(key)
+    {
+      case Key::Target: z.target_raw = v; break;
+      case Key::Max:    z.max_raw = v; break;
+      case Key::Hyst:
+        if(v < 0 || v > 0xFF) return false;
+        z.hyst_raw = static_cast<uint8_t>(v);
+        break;
+      case Key::Rise:
+        if(v < 0 || v > 0xFF) return false;
+        z.rise_raw = static_cast<uint8_t>(v);
+        break;
+      case Key::RiseWait:
+        if(v < 0) return false;
+        z.rise_wait_s = static_cast<uint16_t>(v);
+        break;
+      default: return false;
+    }
+    if(!ZoneValid(z, ceiling_raw)) return false;
+    rec_.zone[i] = z;
+    Changed();
+    return true;
+  }
+  static bool SetReadInterval(uint16_t const ms)
+  {
+    if(!IntervalValid(ms)) return false;
+    rec_.read_interval_ms = ms;
+    Changed();
+    return true;
+  }
+  static void RestoreDefaults()
+  {
+    Defaults(rec_, ZoneIndices{});
+    Changed();
+  }
+
+  // Call every loop(): writes the block back once changes have settled.
+  static void Update()
+  {
+    if(!dirty_ || millis() - changed_ms_ < CONFIG_COMMIT_DELAY_MS) return;
+    rec_.version = VERSION;
+    rec_.zones = ZONE_COUNT;
+    rec_.crc = Crc16(&rec_, CRC_LEN);
+    EEPROM.put(EE_CONFIG_BASE, rec_);
+    dirty_ = false;
+    from_eeprom_ = true;
+    SysLog::println(LOG_STR("CFG: saved"));
+  }
+
+  static void PrintSource()
+  {
+    SysLog::println(LOG_STR("CFG: "), from_eeprom_ ? LOG_STR("eeprom") : LOG_STR("defaults"),
+                    dirty_ ? LOG_STR(" (unsaved)") : LOG_STR(""));
+  }
+  static void Print(uint8_t const uid, uint8_t const i)
+  {
+    ZoneSettings const& z{ rec_.zone[i] };
+    SysLog::println(LOG_STR("CFG: "), uid, LOG_STR(" target "), Temp16{ z.target_raw }, LOG_STR(" max "), Temp16{ z.max_raw },
+                    LOG_STR(" hyst "), Temp16{ z.hyst_raw }, LOG_STR(" rise "), Temp16{ z.rise_raw },
+                    LOG_STR(" in "), z.rise_wait_s, LOG_STR(" s"));
+  }
+  static void PrintInterval()
+  {
+    SysLog::println(LOG_STR("CFG: interval "), rec_.read_interval_ms, LOG_STR(" ms"));
+  }
+
+private:
+  static constexpr uint8_t VERSION = 1U;
+  static constexpr uint16_t INTERVAL_MIN_MS = static_cast<uint16_t>(SAMPLE_LATENCY_MS);
+
+  struct Record
+  {
+    uint8_t version;
+    uint8_t zones;
+    uint16_t read_interval_ms;
+    ZoneSettings zone[ZONE_COUNT];
+    uint16_t crc; // over everything above
+  };
+  static constexpr uint8_t CRC_LEN = offsetof(Record, crc);
+  static_assert(sizeof(Record) <= EE_CONFIG_SIZE, "Config does not fit its EEPROM region");
+  static_assert(READ_INTERVAL_MAX_MS <= 0xFFFFUL, "Config stores the read interval as u16");
+
+  template<uint8_t I>
+  static constexpr ZoneSettings DefaultZone()
+  {
+    return ZoneSettings{ TempToRaw(ZONES[I].target_c), TempToRaw(ZONES[I].max_c),
+                         static_cast<uint8_t>(TempToRaw(TEMP_ALLOWANCE)), static_cast<uint8_t>(TempToRaw(DESYNC_RISE_C)),
+                         static_cast<uint16_t>(DESYNC_WAIT_MS / 1000UL) };
+  }
+  template<uint8_t... I>
+  static void Defaults(Record& r, IndexSeq<I...>)
+  {
+    r.version = VERSION;
+    r.zones = ZONE_COUNT;
+    r.read_interval_ms = static_cast<uint16_t>(READ_INTERVAL_MS);
+    ZoneSettings const zones[] = { DefaultZone<I>()... };
+    for(uint8_t i{}; i < ZONE_COUNT; ++i) r.zone[i] = zones[i];
+  }
+
+  static bool Valid(Record const& r)
+  {
+    return r.version == VERSION && r.zones == ZONE_COUNT && r.crc == Crc16(&r, CRC_LEN)
+        && IntervalValid(r.read_interval_ms) && ZonesValid(r, ZoneIndices{});
+  }
+  template<uint8_t... I>
+  static bool ZonesValid(Record const& r, IndexSeq<I...>)
+  {
+    bool ok{ true };
+    bool const each[] = { (ok = ok && ZoneValid(r.zone[I], TempToRaw(ZONES[I].max_c)))... };
+    (void)each;
+    return ok;
+  }
+  static constexpr bool ZoneValid(ZoneSettings const& z, int16_t const ceiling_raw)
+  {
+    return z.max_raw <= ceiling_raw
+        && z.hyst_raw >= HYST_MIN_RAW && z.hyst_raw <= HYST_MAX_RAW
+        && z.target_raw >= TempToRaw(TARGET_MIN_C)
+        && z.target_raw + z.hyst_raw + TempToRaw(TARGET_MARGIN_C) <= z.max_raw
+        && z.rise_raw >= RISE_MIN_RAW && z.rise_raw <= RISE_MAX_RAW
+        && z.rise_wait_s >= RISE_WAIT_MIN_S && z.rise_wait_s <= RISE_WAIT_MAX_S;
+  }
+  // up to READ_INTERVAL_MAX_MS, so one missed sample stays inside SUPERVISOR_STALE_MS
+  static constexpr bool IntervalValid(uint16_t const ms)
+  {
+    return ms >= INTERVAL_MIN_MS && ms <= READ_INTERVAL_MAX_MS;
+  }
+  static void Changed()
+  {
+    dirty_ = true;
+    changed_ms_ = millis();
+  }
+
+  static Record rec_;
+  static unsigned long changed_ms_;
+  static bool dirty_;
+  static bool from_eeprom_;
+};
+
+// -----------------------------------------------------------------------------
+// Supervisor
+// -----------------------------------------------------------------------------
+// Supervisor: last line of defence that does not depend on loop() making progress.
+// Timer2 fires TIMER2_COMPA every ~10 ms; the ISR checks every registered zone's
+// last good sample time and temperature and forces the relay off directly if the
+// sample is stale (SUPERVISOR_STALE_MS) or at/over max. Begin() reprograms Timer2
+// for that, which takes the PWM off pins 3 and 11 (no analogWrite() there).
+// A tripped zone stays tripped and its relay is re-forced off on every tick, so the
+// worst case from a stall or over-max sample to relay off is one tick (~10 ms).
+// loop() then escalates the trip into a normal PANIC once it runs again.
+// A zone that faulted on its own (see TempController::Fault) is Isolate()d: its
+// relay is forced off on every tick from then on, but missing samples from it are
+// no longer a trip. Readmit() undoes it once the zone recovered.
+// Over max is a trip too, unless OverMax is zone scoped (OVERMAX_ZONE_FAULT): then
+// the tick only forces that relay off and the zone faults itself on the same
+// sample, so stale samples are the only trip that still stops every zone.
+//
+// Temperatures are kept as Temp16 raw integers so the ISR never touches floats.
+
+class Supervisor
+{
+public:
+  static constexpr uint8_t MAX_ZONES = ZONE_COUNT;
+  static constexpr uint8_t NO_SLOT = 0xFFU;
+
+  // Call before Begin(). Returns the slot to Feed(), or NO_SLOT when full.
+  static uint8_t Register(uint8_t const uid, float const max_c, PinDrive const relay)
+  {
+    if(count_ >= MAX_ZONES || relay == nullptr) return NO_SLOT;
+
+    Slot& z = slots_[count_];
+    z.relay = relay;
+    z.uid = uid;
+    z.max_raw = TempToRaw(max_c);
+    z.raw = 0;   // no sample yet; the staleness check covers it
+    z.last_ms = millis();
+    return count_++;
+  }
+
+  static void Begin()
+  {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+      TCCR2A = _BV(WGM21);                        // CTC on OCR2A
+      TCCR2B = _BV(CS22) | _BV(CS21) | _BV(CS20); // clk/1024 -> 15625 Hz
+      OCR2A  = 155U;                              // /156 -> ~100 Hz
+      TIMSK2 = _BV(OCIE2A);
+    }
+  }
+
+  // Hand the supervisor a good sample. Multi-byte fields are shared with the ISR.
+  static void Feed(uint8_t const slot, int16_t const raw)
+  {
+    if(slot >= count_) return;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+      slots_[slot].raw = raw;
+      slots_[slot].last_ms = millis();
+    }
+  }
+
+  static void Isolate(uint8_t const slot)
+  {
+    if(slot >= count_) return;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+      isolated_mask_ |= static_cast<uint8_t>(1U << slot);
+    }
+  }
+
+  // back to being checked for staleness; Feed() has kept its sample fresh meanwhile
+  static void Readmit(uint8_t const slot)
+  {
+    if(slot >= count_) return;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+      isolated_mask_ &= static_cast<uint8_t>(~(1U << slot));
+    }
+  }
+
+  // True once any zone has tripped; uid is the lowest tripped slot's uid.
+  static bool Tripped(uint8_t& uid)
+  {
+    uint8_t const mask{ tripped_mask_ };
+    for(uint8_t i{}; i < count_; ++i)
+    {
+      if(mask & (1U << i))
+      {
+        uid = slots_[i].uid;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // ISR context only.
+  static void Tick()
+  {
+    unsigned long const now{ millis() };
+    for(uint8_t i{}; i < count_; ++i)
+    {
+      Slot& z = slots_[i];
+      uint8_t const bit = static_cast<uint8_t>(1U << i);
+      bool const isolated{ (isolated_mask_ & bit) != 0U };
+      bool const over{ z.raw >= z.max_raw };
+      if((tripped_mask_ & bit) || (!isolated && now - z.last_ms > SUPERVISOR_STALE_MS)
+         || (over && !Panic::IsZoneScoped(PanicReason::OverMax)))
+      {
+        z.relay(RELAY_INACTIVE_STATE);
+        tripped_mask_ |= bit;
+      }
+      else if(isolated || over)
+      {
+        z.relay(RELAY_INACTIVE_STATE);
+      }
+    }
+  }
+
+private:
+  struct Slot
+  {
+    PinDrive relay;
+    uint8_t uid;
+    int16_t max_raw;
+    volatile int16_t raw;
+    volatile unsigned long last_ms;
+  };
+
+  static Slot slots_[MAX_ZONES];
+  static uint8_t count_;
+  static volatile uint8_t tripped_mask_;
+  static volatile uint8_t isolated_mask_;
+};
+
+// -----------------------------------------------------------------------------
+// Watchdog
+// -----------------------------------------------------------------------------
+// Watchdog: AVR WDT (8 s) that is only fed once every critical task has checked in
+// since the last feed: loop(), the control pass, and each zone's acquisition.
+// While a panic is latched the zones stop sampling on purpose, so only loop()
+// is required then.
+//
+// The WDT runs in reset-only mode, so it resets the board even if whatever hung
+// has interrupts disabled. Service() keeps the mask of tasks still owed a check-in
+// in a .noinit record on every pass, and once the WDT is OVERDUE_MS unfed the
+// supervisor tick marks that record as overdue. At boot, WDRF in MCUSR or an
+// overdue record means a watchdog reset; the record then names the tasks. Optiboot
+// clears MCUSR before starting the sketch, so with interrupts off as well the
+// reset can only read Unknown.
+//
+// Task mask bits: 0 = loop, 1 = control, 2.. = zone acquisition in Begin() order.
+
+enum class ResetCause : uint8_t
+{
+  Unknown = 0,
+  PowerOn,
+  External,
+  BrownOut,
+  Watchdog
+};
+LogStr ResetCauseStr(ResetCause c)
+{
+  switch (c)
+  {
+    case ResetCause::PowerOn:  return LOG_STR("PowerOn");
+    case ResetCause::External: return LOG_STR("External");
+    case ResetCause::BrownOut: return LOG_STR("BrownOut");
+    case ResetCause::Watchdog: return LOG_STR("Watchdog");
+    default:                   return LOG_STR("Unknown");
+  }
+}
+
+class Watchdog
+{
+public:
+  using TaskMask = uint8_t;
+  static constexpr TaskMask LOOP    = 0x01U;
+  static constexpr TaskMask CONTROL = 0x02U;
+  static_assert(ZONE_COUNT <= 6U, "Watchdog TaskMask has one bit per zone after LOOP and CONTROL");
+
+  // Call first thing in setup(). Optiboot may already have cleared MCUSR, in which
+  // case only our own watchdog record survives and anything else reads Unknown.
+  // After a power-on or brown-out the .noinit record is whatever SRAM came up
+  // with, so it is ignored then.
+  static void CaptureResetCause()
+  {
+    uint8_t const flags{ MCUSR };
+    MCUSR = 0U;
+    wdt_disable();
+
+    missed_tasks_ = 0U;
+    bool const cold{ (flags & (_BV(PORF) | _BV(BORF))) != 0U };
+    bool const valid{ !cold && record_.magic == RECORD_MAGIC };
+    if(flags & _BV(PORF))       reset_cause_ = ResetCause::PowerOn;
+    else if(flags & _BV(BORF))  reset_cause_ = ResetCause::BrownOut;
+    else if((flags & _BV(WDRF)) || (valid && record_.overdue))
+    {
+      reset_cause_ = ResetCause::Watchdog;
+      if(valid) missed_tasks_ = record_.missed_tasks;
+    }
+    else if(flags & _BV(EXTRF)) reset_cause_ = ResetCause::External;
+    else                        reset_cause_ = ResetCause::Unknown;
+
+    record_.magic = 0U;
+  }
+
+  static ResetCause LastResetCause() { return reset_cause_; }
+
+  static void PrintResetCause()
+  {
+    SysLog::print(LOG_STR("Reset: "), ResetCauseStr(reset_cause_));
+    if(reset_cause_ == ResetCause::Watchdog)
+    {
+      SysLog::print(LOG_STR(" (missed task mask: "), missed_tasks_, LOG_STR(")"));
+    }
+    SysLog::println();
+  }
+
+  // Returns the task bit to CheckIn() with, or 0 when out of bits.
+  static TaskMask RegisterTask()
+  {
+    if(next_task_ == 0U) return 0U;
+    TaskMask const bit{ next_task_ };
+    registered_ |= bit;
+    next_task_ = static_cast<TaskMask>(next_task_ << 1);
+    return bit;
+  }
+
+  static void CheckIn(TaskMask const task) { checked_in_ |= task; }
+
+  static void Begin()
+  {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+      record_.missed_tasks = 0U;
+      record_.overdue = false;
+      record_.magic = RECORD_MAGIC;
+      fed_ms_ = millis();
+      wdt_reset();
+      WDTCSR = _BV(WDCE) | _BV(WDE);
+      WDTCSR = _BV(WDE) | _BV(WDP3) | _BV(WDP0); // reset only, 8 s
+    }
+  }
+
+  // Call from loop(); feeds the WDT once every required task has checked in.
+  static void Service()
+  {
+    TaskMask const pending{ static_cast<TaskMask>(RequiredTasks() & ~checked_in_) };
+    record_.missed_tasks = pending;
+    if(pending != 0U) return;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+      wdt_reset();
+      fed_ms_ = millis();
+      record_.overdue = false;
+      checked_in_ = 0U;
+    }
+  }
+
+  // Supervisor tick, ISR context. Still runs when loop() is stuck, so it is what
+  // marks the record for a hang inside a pass.
+  static void Tick()
+  {
+    if(record_.magic != RECORD_MAGIC || record_.overdue) return;
+    if(millis() - fed_ms_ < OVERDUE_MS) return;
+    record_.missed_tasks = static_cast<TaskMask>(RequiredTasks() & ~checked_in_);
+    record_.overdue = true;
+  }
+
+private:
+  static constexpr uint16_t RECORD_MAGIC = 0xD06EU;
+  // Longer than any healthy gap between feeds, and short enough that the WDT
+  // oscillator (nominally 8 s, allow it to run 25% fast) has not fired yet.
+  static constexpr unsigned long OVERDUE_MS = READ_INTERVAL_MAX_MS + 1000UL;
+  static_assert(OVERDUE_MS <= 6000UL, "Watchdog record must be marked before the 8 s WDT fires");
+
+  struct Record
+  {
+    uint16_t magic;
+    TaskMask missed_tasks;
+    bool overdue;
+  };
+
+  static TaskMask RequiredTasks()
+  {
+    return Panic::IsPanic() ? LOOP : static_cast<TaskMask>(registered_ | LOOP | CONTROL);
+  }
+
+  static Record record_;
+  static unsigned long fed_ms_;
+  static ResetCause reset_cause_;
+  static TaskMask missed_tasks_;
+  static TaskMask registered_;
+  static TaskMask next_task_;
+  static volatile TaskMask checked_in_;
+};
+
+ISR(TIMER2_COMPA_vect)
+{
+  Supervisor::Tick();
+  Watchdog::Tick();
+}
+
+// -----------------------------------------------------------------------------
+// Window Stats
+// -----------------------------------------------------------------------------
+// WindowStats: running min/max/mean temperature, heater duty and relay transition
+// count of one zone over STATS_WINDOW_MS, in constant RAM. Duty comes from the
+// relay edges themselves, not from sampling, so it is exact to the millisecond.
+
+struct WindowSummary
+{
+  uint16_t samples;
+  int16_t  min_raw;
+  int16_t  mean_raw;
+  int16_t  max_raw;
+  uint16_t duty_permille;
+  uint16_t transitions;
+};
+
+class WindowStats
+{
+public:
+  WindowStats():
+    start_ms_(),
+    on_since_ms_(),
+    on_ms_(),
+    sum_raw_(),
+    samples_(),
+    min_raw_(),
+    max_raw_(),
+    transitions_()
+  {}
+
+  void Restart(unsigned long const now)
+  {
+    start_ms_ = on_since_ms_ = now;
+    on_ms_ = 0UL;
+    sum_raw_ = 0L;
+    samples_ = 0U;
+    transitions_ = 0U;
+  }
+  void Add(int16_t const raw)
+  {
+    if(samples_ == 0U || raw < min_raw_) min_raw_ = raw;
+    if(samples_ == 0U || raw > max_raw_) max_raw_ = raw;
+    sum_raw_ += raw;
+    if(samples_ != 0xFFFFU) ++samples_;
+  }
+  void HeaterOn(unsigned long const now)
+  {
+    on_since_ms_ = now;
+    ++transitions_;
+  }
+  void HeaterOff(unsigned long const now)
+  {
+    on_ms_ += now - on_since_ms_;
+    ++transitions_;
+  }
+  bool Due(unsigned long const now) const
+  {
+    return now - start_ms_ >= STATS_WINDOW_MS;
+  }
+  // Summary of the window up to now; call Restart() after.
+  WindowSummary Close(unsigned long const now, bool const heater_on) const
+  {
+    unsigned long const elapsed{ now - start_ms_ };
+    unsigned long const on{ on_ms_ + (heater_on ? now - on_since_ms_ : 0UL) };
+    unsigned long duty{};
+    if(elapsed != 0UL)
+    {
+      // on * 1000 overflows past ~71 minutes
+      duty = elapsed < 4000000UL ? (on * 1000UL) / elapsed : on / (elapsed / 1000UL);
+    }
+
+    WindowSummary w;
+    w.samples = samples_;
+    w.min_raw = samples_ ? min_raw_ : 0;
+    w.max_raw = samples_ ? max_raw_ : 0;
+    w.mean_raw = samples_ ? static_cast<int16_t>(sum_raw_ / static_cast<int32_t>(samples_)) : 0;
+    w.duty_permille = static_cast<uint16_t>(duty > 1000UL ? 1000UL : duty);
+    w.transitions = transitions_;
+    return w;
+  }
+
+private:
+  unsigned long start_ms_;
+  unsigned long on_since_ms_;
+  unsigned long on_ms_;
+  int32_t sum_raw_;
+  uint16_t samples_;
+  int16_t min_raw_;
+  int16_t max_raw_;
+  uint16_t transitions_;
+};
+
+// -----------------------------------------------------------------------------
+// Telemetry
+// -----------------------------------------------------------------------------
+// Binary telemetry (TELEMETRY Binary or Tokenized): one fixed-layout frame per
+// sample instead of a formatted line, no float formatting on the board.
+// Frames are wrapped as described at Frame.
+//
+// Frame::STATE payload, little endian:
+//   u8  type    Frame::STATE
+//   u8  uid
+//   i16 raw     temperature in 1/16 C
+//   u8  state   0 HEATING, 1 COOLING, 2 OFF
+//   u8  relay   1 = heater on
+//   u8  flags   FLAG_PANIC, FLAG_DROPPED (Log output was lost since the last frame)
+//   u32 ms      millis() at the sample
+// Frame::STATS payload, little endian, one per zone per STATS_WINDOW_MS:
+//   u8  type    Frame::STATS
+//   u8  uid
+//   u16 samples
+//   i16 min, mean, max   1/16 C
+//   u16 duty    heater on-time, per mille of the window
+//   u16 transitions      relay switches in the window
+//   u32 ms      millis() at the end of the window
+// Frame::TOKEN payloads are Log lines in Tokenized mode, see TokenFrame.
+
+class Telemetry
+{
+public:
+  static constexpr uint8_t FLAG_PANIC   = 0x01U;
+  static constexpr uint8_t FLAG_DROPPED = 0x02U;
+
+  static void SendState(uint8_t const uid, int16_t const raw, uint8_t const state, bool const relay_on)
+  {
+    uint8_t flags{ static_cast<uint8_t>(Panic::IsPanic() ? FLAG_PANIC : 0U) };
+    if(Log::dropped() != 0U) flags |= FLAG_DROPPED;
+
+    uint32_t const ms{ millis() };
+    uint8_t const payload[STATE_LEN] =
+    {
+      Frame::STATE,
+      uid,
+      static_cast<uint8_t>(raw), static_cast<uint8_t>(static_cast<uint16_t>(raw) >> 8),
+      state,
+      static_cast<uint8_t>(relay_on ? 1U : 0U),
+      flags,
+      static_cast<uint8_t>(ms), static_cast<uint8_t>(ms >> 8),
+      static_cast<uint8_t>(ms >> 16), static_cast<uint8_t>(ms >> 24)
+    };
+    Send(payload, STATE_LEN);
+  }
+
+  static void SendStats(uint8_t const uid, WindowSummary const& w)
+  {
+    uint8_t payload[STATS_LEN];
+    payload[0] = Frame::STATS;
+    payload[1] = uid;
+    PutU16(&payload[2], w.samples);
+    PutU16(&payload[4], static_cast<uint16_t>(w.min_raw));
+    PutU16(&payload[6], static_cast<uint16_t>(w.mean_raw));
+    PutU16(&payload[8], static_cast<uint16_t>(w.max_raw));
+    PutU16(&payload[10], w.duty_permille);
+    PutU16(&payload[12], w.transitions);
+    uint32_t const ms{ millis() };
+    PutU16(&payload[14], static_cast<uint16_t>(ms));
+    PutU16(&payload[16], static_cast<uint16_t>(ms >> 16));
+    Send(payload, STATS_LEN);
+  }
+
+private:
+  static constexpr uint8_t STATE_LEN = 11U;
+  static constexpr uint8_t STATS_LEN = 18U;
+
+  static void PutU16(uint8_t* p, uint16_t const v)
+  {
+    p[0] = static_cast<uint8_t>(v);
+    p[1] = static_cast<uint8_t>(v >> 8);
+  }
+
+  static void Send(uint8_t const* payload, uint8_t const len)
+  {
+    uint8_t frame[Frame::MAX_SIZE];
+    Log::write(frame, Frame::Encode(payload, len, frame));
+  }
+};
+
+// -----------------------------------------------------------------------------
+// History
+// -----------------------------------------------------------------------------
+// History: per-zone temperature and heater state every HISTORY_INTERVAL_MS, kept
+// in an EEPROM ring so the last hours survive a reset and can be read back after
+// an incident, whether or not a PC was attached at the time.
+//
+// The ring is PAGES pages of PAGE bytes, one page written at a time:
+//   header (keyframe): u16 seq, i16 raw[ZONES] absolute 1/16 C,
+//                      u8 flags (FLAG_BOOT: first page since power-up), u8 heater bits, u16 CRC16
+//   samples: one nibble per zone, zone 0 in the low nibble, pad nibble 0:
+//            bit3 heater on, bits0..2 delta + 3 against the previous value
+// Deltas are clamped to +/-3/16 C per interval; the encoder tracks the decoded
+// value so a fast change is caught up over the next samples instead of drifting.
+// Code 7 is never used, so an unwritten 0xFF byte marks the end of a page; every
+// sample write re-erases the byte after it. A new page (a fresh keyframe) is
+// started on boot and when the current one is full.
+//
+// Dump() sends every valid page oldest first as Frame::HISTORY frames:
+//   u8 type, u8 pages left after this one, u16 interval s, u8 ZONES, PAGE bytes as stored
+// one per loop() pass, only when the Log ring has room. tools/logdict.py decodes.
+
+class History
+{
+public:
+  static constexpr uint8_t ZONES = ZONE_COUNT;
+  static constexpr uint8_t PAGE = 32U;
+  static constexpr uint8_t PAGES = EE_HISTORY_SIZE / PAGE;
+
+  struct Sample
+  {
+    int16_t raw;
+    bool heater;
+  };
+
+  static void Begin()
+  {
+    bool found{ false };
+    uint16_t newest{};
+    for(uint8_t p{}; p < PAGES; ++p)
+    {
+      Header h;
+      if(!ReadHeader(p, h)) continue;
+      if(!found || static_cast<int16_t>(h.seq - newest) > 0)
+      {
+        newest = h.seq;
+        page_ = p;
+        found = true;
+      }
+    }
+    next_seq_ = found ? static_cast<uint16_t>(newest + 1U) : 0U;
+    if(!found) page_ = PAGES - 1U;
+    pos_ = PAGE; // force a keyframe
+    boot_ = true;
+  }
+
+  static void Record(Sample const (&s)[ZONES])
+  {
+    if(pos_ + BYTES_PER_SAMPLE > PAGE)
+    {
+      StartPage(s);
+      return;
+    }
+
+    uint16_t const base{ PageAddr(page_) };
+    for(uint8_t b{}; b < BYTES_PER_SAMPLE; ++b)
+    {
+      uint8_t byte{};
+      for(uint8_t n{}; n < 2U; ++n)
+      {
+        uint8_t const z{ static_cast<uint8_t>(2U * b + n) };
+        if(z < ZONES) byte |= static_cast<uint8_t>(Encode(z, s[z]) << (4U * n));
+      }
+      EEPROM.update(base + pos_++, byte);
+    }
+    if(pos_ < PAGE) EEPROM.update(base + pos_, 0xFFU);
+  }
+
+  static void Dump()
+  {
+    cursor_ = 1U;
+  }
+
+  // Call regularly from loop(); sends at most one page of a pending Dump().
+  static void Update()
+  {
+    while(cursor_ != 0U)
+    {
+      if(cursor_ > PAGES)
+      {
+        cursor_ = 0U;
+        return;
+      }
+      if(Log::room() < Frame::MAX_SIZE) return;
+
+      uint8_t frame[Frame::MAX_SIZE];
+      uint8_t const n{ PageFrame(cursor_++, frame) };
+      if(n == 0U) continue;
+      Log::write(frame, n);
+      return;
+    }
+  }
+
+  // The whole dump at once, straight to Serial: for builds without CONNECT_TO_PC,
+  // where there is no Log and nothing else on the port (see Console::Poll()).
+  // About 1 KB, under 0.1 s at 115200 baud.
+  static void DumpBlocking()
+  {
+    for(uint8_t c{ 1U }; c <= PAGES; ++c)
+    {
+      uint8_t frame[Frame::MAX_SIZE];
+      uint8_t const n{ PageFrame(c, frame) };
+      if(n != 0U) Serial.write(frame, n);
+    }
+    Serial.flush();
+  }
+
+private:
+  static constexpr uint8_t FLAG_BOOT = 0x01U;
+  static constexpr uint8_t BYTES_PER_SAMPLE = (ZONES + 1U) / 2U;
+  static constexpr uint8_t HEAD = 5U; // Frame::HISTORY payload before the page
+
+  // Frame::HISTORY for the cursor-th page, oldest first (the page after the one
+  // being written); 0 for an empty or corrupt page.
+  static uint8_t PageFrame(uint8_t const cursor, uint8_t (&frame)[Frame::MAX_SIZE])
+  {
+    uint8_t const p{ static_cast<uint8_t>((page_ + cursor) % PAGES) };
+    Header h;
+    if(!ReadHeader(p, h)) return 0U;
+
+    uint8_t payload[HEAD + PAGE];
+    payload[0] = Frame::HISTORY;
+    payload[1] = static_cast<uint8_t>(PAGES - cursor); // pages left after this one
+    uint16_t const interval_s{ static_cast<uint16_t>(HISTORY_INTERVAL_MS / 1000UL) };
+    payload[2] = static_cast<uint8_t>(interval_s);
+    payload[3] = static_cast<uint8_t>(interval_s >> 8);
+    payload[4] = ZONES; // the page layout depends on it
+    for(uint8_t i{}; i < PAGE; ++i) payload[HEAD + i] = EEPROM.read(PageAddr(p) + i);
+    return Frame::Encode(payload, sizeof(payload), frame);
+  }
+
+  struct Header
+  {
+    uint16_t seq;
+    int16_t raw[ZONES];
+    uint8_t flags;
+    uint8_t heater;
+    uint16_t crc; // over everything above
+  };
+  static constexpr uint8_t CRC_LEN = offsetof(Header, crc);
+  static_assert(ZONES >= 1U && ZONES <= 8U, "History heater bits fit one byte");
+  static_assert(sizeof(Header) == 6U + 2U * ZONES, "Header has padding; tools/logdict.py reads it packed");
+  static_assert(sizeof(Header) + BYTES_PER_SAMPLE <= PAGE, "History PAGE too small for ZONES");
+  static_assert(HEAD + PAGE <= Frame::MAX_PAYLOAD, "History page does not fit a frame");
+  static_assert(PAGES >= 2U, "History needs at least two pages");
+
+  static uint16_t PageAddr(uint8_t const p)
+  {
+    return static_cast<uint16_t>(EE_HISTORY_BASE + p * static_cast<uint16_t>(PAGE));
+  }
+  static bool ReadHeader(uint8_t const p, Header& h)
+  {
+    EEPROM.get(PageAddr(p), h);
+    return h.crc == Crc16(&h, CRC_LEN);
+  }
+
+  static void StartPage(Sample const (&s)[ZONES])
+  {
+    page_ = static_cast<uint8_t>((page_ + 1U) % PAGES);
+
+    Header h;
+    memset(&h, 0, sizeof(h));
+    h.seq = next_seq_++;
+    h.flags = boot_ ? FLAG_BOOT : 0U;
+    for(uint8_t z{}; z < ZONES; ++z)
+    {
+      h.raw[z] = last_raw_[z] = s[z].raw;
+      if(s[z].heater) h.heater |= static_cast<uint8_t>(1U << z);
+    }
+    h.crc = Crc16(&h, CRC_LEN);
+    boot_ = false;
+
+    EEPROM.put(PageAddr(page_), h);
+    pos_ = sizeof(Header);
+    EEPROM.update(PageAddr(page_) + pos_, 0xFFU);
+  }
+
+  static uint8_t Encode(uint8_t const z, Sample const& s)
+  {
+    int16_t d{ static_cast<int16_t>(s.raw - last_raw_[z]) };
+    if(d > 3) d = 3;
+    if(d < -3) d = -3;
+    last_raw_[z] = static_cast<int16_t>(last_raw_[z] + d);
+    return static_cast<uint8_t>((s.heater ? 0x08U : 0U) | static_cast<uint8_t>(d + 3));
+  }
+
+  static int16_t last_raw_[ZONES];
+  static uint16_t next_seq_;
+  static uint8_t page_;   // page being written
+  static uint8_t pos_;    // next byte in it
+  static uint8_t cursor_; // Dump(): 0 idle, else 1 + pages sent
+  static bool boot_;
+};
+
+// -----------------------------------------------------------------------------
+// Energy
+// -----------------------------------------------------------------------------
+// Energy: relay on-time per zone, turned into heat mat energy with ZoneConfig::mat_w.
+// loop() hands Update() the heater bits every pass; the time since the previous
+// pass counts for every heater that was on during it. Every ENERGY_REPORT_MS (an
+// hour) each zone's duty and Wh for that hour go out, and every ENERGY_DAY_REPORTS
+// of them (a day) the same for the day. The board has no clock, so hours and days
+// are counted from power-up.
+//
+// The lifetime on-time per zone, in seconds, is checkpointed hourly to
+// EE_ENERGY_BASE (versioned, CRC-protected, EEPROM.put only rewrites changed
+// bytes), so a reset loses at most the hour in progress. Totals are in Wh at the
+// mat_w configured now. Energy is integer maths throughout, printed as tenths.
+
+class Energy
+{
+public:
+  static constexpr uint8_t ZONES = ZONE_COUNT;
+  static_assert(ZONES <= 8U, "one heater bit per zone");
+
+  static void Begin()
+  {
+    Record r;
+    EEPROM.get(EE_ENERGY_BASE, r);
+    bool const valid{ r.version == VERSION && r.zones == ZONES && r.crc == Crc16(&r, CRC_LEN) };
+    for(uint8_t z{}; z < ZONES; ++z)
+    {
+      total_s_[z] = valid ? r.on_s[z] : 0UL;
+      hour_ms_[z] = 0UL;
+      day_ms_[z] = 0UL;
+    }
+    last_ms_ = hour_start_ms_ = millis();
+    heater_ = 0U;
+    hours_ = 0U;
+  }
+
+  // Call every loop() with bit z set while zone z heats.
+  static void Update(uint8_t const heater)
+  {
+    unsigned long const now{ millis() };
+    unsigned long const dt{ now - last_ms_ };
+    for(uint8_t z{}; z < ZONES; ++z)
+    {
+      if(heater_ & (1U << z)) hour_ms_[z] += dt;
+    }
+    last_ms_ = now;
+    heater_ = heater;
+
+    if(now - hour_start_ms_ < ENERGY_REPORT_MS) return;
+    hour_start_ms_ = now;
+    bool const day_done{ ++hours_ >= ENERGY_DAY_REPORTS };
+    for(uint8_t z{}; z < ZONES; ++z)
+    {
+      PrintLine<CtrlLog>(z, LOG_STR(" hour duty "), hour_ms_[z], ENERGY_REPORT_MS);
+      total_s_[z] += hour_ms_[z] / 1000UL;
+      day_ms_[z] += hour_ms_[z];
+      hour_ms_[z] = 0UL;
+      if(day_done)
+      {
+        PrintLine<CtrlLog>(z, LOG_STR(" day duty "), day_ms_[z], ENERGY_DAY_REPORTS * ENERGY_REPORT_MS);
+        day_ms_[z] = 0UL;
+      }
+    }
+    if(day_done) hours_ = 0U;
+    Checkpoint();
+  }
+
+  // Console "energy": the hour and the day so far and the lifetime total
+  static void Print()
+  {
+    unsigned long const hour_span{ millis() - hour_start_ms_ };
+    for(uint8_t z{}; z < ZONES; ++z)
+    {
+      PrintLine<SysLog>(z, LOG_STR(" hour duty "), hour_ms_[z], hour_span);
+      PrintLine<SysLog>(z, LOG_STR(" day duty "), day_ms_[z] + hour_ms_[z], hours_ * ENERGY_REPORT_MS + hour_span);
+      uint32_t const wh10{ (total_s_[z] + hour_ms_[z] / 1000UL) / 36UL * MatW(z) / 10UL }; // no overflow for years
+      SysLog::println(LOG_STR("ENERGY: "), ::ZONES[z].uid, LOG_STR(" total "), wh10 / 10UL, '.', wh10 % 10UL,
+                      LOG_STR(" Wh"));
+    }
+  }
+
+private:
+  static constexpr uint8_t VERSION = 1U;
+
+  struct Record
+  {
+    uint8_t version;
+    uint8_t zones;
+    uint32_t on_s[ZONES]; // lifetime heater on-time
+    uint16_t crc;         // over everything above
+  };
+  static constexpr uint8_t CRC_LEN = offsetof(Record, crc);
+  static_assert(sizeof(Record) <= EE_ENERGY_SIZE, "Energy does not fit its EEPROM region");
+
+  static uint32_t MatW(uint8_t const z) { return ::ZONES[z].mat_w; }
+
+  static void Checkpoint()
+  {
+    Record r;
+    r.version = VERSION;
+    r.zones = ZONES;
+    for(uint8_t z{}; z < ZONES; ++z) r.on_s[z] = total_s_[z];
+    r.crc = Crc16(&r, CRC_LEN);
+    EEPROM.put(EE_ENERGY_BASE, r);
+  }
+  // "ENERGY: <uid><what><duty>% <Wh> Wh", on_ms of span_ms
+  template<typename L>
+  static void PrintLine(uint8_t const z, LogStr const what, uint32_t const on_ms, uint32_t const span_ms)
+  {
+    uint32_t const span_s{ span_ms / 1000UL };
+    uint32_t permille{ span_s == 0UL ? 0UL : on_ms / span_s };
+    if(permille > 1000UL) permille = 1000UL;
+    uint32_t const wh10{ on_ms / 1000UL * MatW(z) / 360UL };
+    L::println(LOG_STR("ENERGY: "), ::ZONES[z].uid, what, permille / 10UL, '.', permille % 10UL,
+               LOG_STR("% "), wh10 / 10UL, '.', wh10 % 10UL, LOG_STR(" Wh"));
+  }
+
+  static uint32_t total_s_[ZONES];
+  static uint32_t hour_ms_[ZONES];
+  static uint32_t day_ms_[ZONES];
+  static unsigned long last_ms_;
+  static unsigned long hour_start_ms_;
+  static uint8_t heater_;
+  static uint8_t hours_;
+};
+
+// -----------------------------------------------------------------------------
+// LED Man
+// -----------------------------------------------------------------------------
+// LEDMan: template-based LED pattern controller.
+// Each template argument is one state (mode).
+// For state i, LED is ON for DurationsMs[i] ms, then OFF for DurationsMs[i] ms, repeating.
+//
+// Example usage:
+//   using HeaterLED = LEDMan<10000UL, 1000UL, 50UL>;
+//   // index 0: slow blink (10 s on, 10 s off)
+//   // index 1: fast blink (1 s on, 1 s off)
+//   // index 2: rapid blink (50 ms on, 50 ms off)
+
+// LEDMan: each template argument is one logical LED state (mode).
+// For state i, LED is ON for DurationsMs[i] ms, then OFF for DurationsMs[i] ms, repeat.
+//
+// Public API:
+//   LEDMan<...>::SetState(stateIndex);   // 0 <= stateIndex < N; else Panic::StartPanic()
+//   LEDMan<...>::Update();               // call regularly from loop() to advance timing and drive LED
+//
+// Assumes:
+//   - Arduino environment (millis(), LED_BUILTIN, HIGH/LOW) and FastPin.
+//   - Panic::StartPanic() exists for error handling.
+
+
+class LEDMan
+{
+public:
+  static unsigned long HalfPeriodForState(unsigned int const state)
+  {
+    switch(state)
+    {
+      case 0U: return 50UL;
+      case 1U: return 1000UL;
+      case 3U: return 250UL; // a zone faulted, the others still run
+      default: return 10000UL;
+    }
+  }
+
+  // defined after the zones (Globals): any zone heating picks the state
+  static void UpdateState();
+
+  // Advance timing in the current state and drive the LED.
+  static void Update()
+  {
+    UpdateState();
+    const unsigned long now     = millis();
+    const unsigned long elapsed = now - lastToggleMs_;
+
+    const unsigned long halfPeriod = HalfPeriodForState(currentStateIndex_);
+
+    if (elapsed >= halfPeriod)
+    {
+      ledOn_ = !ledOn_;
+      lastToggleMs_ = now;
+    }
+
+    FastPin<LED_BUILTIN>::Write(ledOn_ ? HIGH : LOW);
+  }
+
+private:
+
+    // Current state index, LED phase, and last toggle time
+    static unsigned int    currentStateIndex_;
+    static bool          ledOn_;
+    static unsigned long lastToggleMs_;
+};
+// -----------------------------------------------------------------------------
+// OneWire Engine
+// -----------------------------------------------------------------------------
+// OwEngine: 1-Wire transactions run from the Timer1 compare interrupt instead of
+// being bit-banged with interrupts off. OneWire holds them off for the whole of
+// every 60-70 us slot, which on a 10 byte MATCH ROM transfer is several ms of
+// blocked UART, Timer0 and Supervisor. Here the ISR only spends the part of a slot
+// that really is timing critical (pull low, release, sample: 10-13 us) and the
+// rest of the slot, the recovery and the reset pulse are Timer1 waits.
+//
+// A transaction is reset + presence, tx_len bytes written, then rx_len bytes read.
+// That covers every periodic DS18B20 access (MATCH ROM, address, command, maybe the
+// scratchpad), so there is no command interpreter in the ISR. Start() returns at
+// once, Collect() picks up the outcome. One transaction at a time for the whole
+// board; the zones take turns (Start() is false while it is busy).
+//
+// The line is driven open drain: low is output with the PORT bit clear, released is
+// input and the external pull-up takes it high. ISR latency from the other handlers
+// only stretches the gaps between slots, which 1-Wire puts no limit on; the one
+// tight window, presence, is sampled early enough to absorb a late interrupt.
+// Timer1 is taken over while a transaction runs, so no analogWrite() on pins 9/10.
+// Search and the setup-time writes stay on the blocking OneWire.
+
+class OwEngine
+{
+public:
+  enum class Status : uint8_t
+  {
+    Idle,
+    Busy,
+    Done,
+    NoPresence
+  };
+  static constexpr uint8_t MAX_BYTES = 10U; // MATCH ROM, 8 address bytes, command
+
+  // rx bytes are read back over the start of the (by then sent) tx bytes.
+  template<uint8_t Pin>
+  static bool Start(uint8_t const* tx, uint8_t const tx_len, uint8_t const rx_len)
+  {
+    if(status_ != Status::Idle || tx_len > MAX_BYTES || rx_len > MAX_BYTES) return false;
+
+    for(uint8_t i{}; i < tx_len; ++i) buf_[i] = tx[i];
+    ddr_ = &FastPin<Pin>::Ddr();
+    in_ = &FastPin<Pin>::In();
+    mask_ = FastPin<Pin>::MASK;
+    tx_bits_ = static_cast<uint8_t>(tx_len * 8U);
+    end_bit_ = static_cast<uint8_t>((tx_len + rx_len) * 8U);
+    bit_ = 0U;
+    FastPin<Pin>::Low(); // no internal pull-up, so released really is released
+
+    // a released line that reads low is shorted or has lost its pull-up; nothing
+    // sampled on it would mean anything, so report it like a missing device
+    if(!(*in_ & mask_))
+    {
+      status_ = Status::NoPresence;
+      return true;
+    }
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+      status_ = Status::Busy;
+      phase_ = Phase::ResetLow;
+      LineLow();
+      TCCR1A = 0U;
+      TCCR1B = _BV(WGM12) | _BV(CS11); // CTC on OCR1A, clk/8 -> 0.5 us ticks
+      Schedule(RESET_US);
+      TIFR1 = _BV(OCF1A);
+      TIMSK1 = _BV(OCIE1A);
+    }
+    return true;
+  }
+
+  // nothing started and nothing left to Collect()
+  static bool IsIdle()
+  {
+    return status_ == Status::Idle;
+  }
+
+  // Busy while the transaction runs. After that the outcome, once: rx gets the
+  // bytes read on Done and the bus is free again.
+  static Status Collect(uint8_t* rx, uint8_t const rx_len)
+  {
+    Status s;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+      s = status_;
+      if(s != Status::Busy && s != Status::Idle)
+      {
+        for(uint8_t i{}; i < rx_len; ++i) rx[i] = buf_[i];
+        status_ = Status::Idle;
+      }
+    }
+    return s;
+  }
+
+  // ISR context only.
+  static void Step()
+  {
+    switch(phase_)
+    {
+      case Phase::ResetLow:
+        LineRelease();
+        phase_ = Phase::Presence;
+        Schedule(PRESENCE_US);
+        break;
+      case Phase::Presence:
+        if(*in_ & mask_)
+        {
+          Finish(Status::NoPresence);
+          break;
+        }
+        phase_ = Phase::Slot;
+        Schedule(RESET_US - PRESENCE_US);
+        break;
+      case Phase::ZeroLow:
+        LineRelease();
+        phase_ = Phase::Slot;
+        Schedule(W0_REST_US);
+        break;
+      default:
+        Slot();
+        break;
+    }
+  }
+
+private:
+  enum class Phase : uint8_t
+  {
+    ResetLow,
+    Presence,
+    Slot,
+    ZeroLow
+  };
+
+  // OneWire's slot timing. Presence is sampled at 65 rather than 70 us: every
+  // device holds the line low at least from 60 to 75 us, and the ISR may run late.
+  static constexpr uint16_t RESET_US = 480U;
+  static constexpr uint16_t PRESENCE_US = 65U;
+  static constexpr uint16_t W1_LOW_US = 10U;
+  static constexpr uint16_t W1_REST_US = 55U;
+  static constexpr uint16_t W0_LOW_US = 65U;
+  static constexpr uint16_t W0_REST_US = 5U;
+  static constexpr uint16_t R_LOW_US = 3U;
+  static constexpr uint16_t R_SAMPLE_US = 10U;
+  static constexpr uint16_t R_REST_US = 53U;
+
+  static void LineLow() { *ddr_ |= mask_; }
+  static void LineRelease() { *ddr_ &= static_cast<uint8_t>(~mask_); }
+  static void Schedule(uint16_t const us)
+  {
+    OCR1A = static_cast<uint16_t>(us * 2U - 1U);
+    TCNT1 = 0U;
+  }
+  static void Finish(Status const s)
+  {
+    TIMSK1 &= static_cast<uint8_t>(~_BV(OCIE1A));
+    TCCR1B = 0U;
+    LineRelease();
+    status_ = s;
+  }
+  // One bit, least significant first. Only the low pulse and the read sample are
+  // waited out in here; a written 0 is released by the next interrupt.
+  static void Slot()
+  {
+    if(bit_ == end_bit_)
+    {
+      Finish(Status::Done);
+      return;
+    }
+    uint8_t const bit{ static_cast<uint8_t>(1U << (bit_ & 7U)) };
+    if(bit_ < tx_bits_)
+    {
+      LineLow();
+      if(buf_[bit_ >> 3] & bit)
+      {
+        delayMicroseconds(W1_LOW_US);
+        LineRelease();
+        Schedule(W1_REST_US);
+      }
+      else
+      {
+        phase_ = Phase::ZeroLow;
+        Schedule(W0_LOW_US);
+      }
+    }
+    else
+    {
+      uint8_t& b = buf_[(bit_ - tx_bits_) >> 3];
+      if(bit == 1U) b = 0U;
+      LineLow();
+      delayMicroseconds(R_LOW_US);
+      LineRelease();
+      delayMicroseconds(R_SAMPLE_US);
+      if(*in_ & mask_) b |= bit;
+      Schedule(R_REST_US);
+    }
+    ++bit_;
+  }
+
+  static uint8_t buf_[MAX_BYTES];
+  static volatile uint8_t* ddr_;
+  static volatile uint8_t* in_;
+  static uint8_t mask_;
+  static uint8_t tx_bits_;
+  static uint8_t end_bit_;
+  static uint8_t bit_;
+  static Phase phase_;
+  static volatile Status status_;
+};
+
+ISR(TIMER1_COMPA_vect)
+{
+  OwEngine::Step();
+}
+
+// -----------------------------------------------------------------------------
+// DS18B20
+// -----------------------------------------------------------------------------
+// Ds18b20<Pin, N>: the N DS18B20s (ZoneConfig::probes) of one zone, all on its pin.
+// The addresses are found once (Begin(), on the blocking OneWire) and every read
+// after that is MATCH ROM to one of them, so a stray extra device on the bus
+// cannot be read by mistake. A reading is Request()ed and then moved along by
+// Poll() on every loop() pass, nothing ever waits: one SKIP ROM CONVERT T through
+// OwEngine starts every probe converting at once, then ConvertMs() later each
+// scratchpad is read in turn. Each value is the sensor's own 16 bit one, which at
+// 1/16 C per LSB already is a Temp16, and is only taken when the scratchpad CRC
+// checks out.
+// A reading is good when at least QUORUM probes answered (two of three, one of
+// one or two), and is then the PROBE_VOTE of those. A probe further than
+// PROBE_DISAGREE_C from the others' majority is the outlier and left out; with no
+// majority at all the reading is not Agreed(). A zone that finds QUORUM probes
+// at Begin() runs on those.
+// TH/TL are written with the resolution; Alarmed() runs the bus' alarm search,
+// where a device answers only while its last reading is outside them.
+
+template<uint8_t Pin, uint8_t N>
+class Ds18b20
+{
+public:
+  static_assert(N >= 1U && N <= 3U, "1 to 3 probes per zone");
+  static constexpr uint8_t FAMILY = 0x28U;
+  static constexpr uint8_t QUORUM = N == 3U ? 2U : 1U;
+  static constexpr uint8_t NO_PROBE = 0xFFU;
+
+  enum class Result : uint8_t
+  {
+    Idle,
+    Pending,
+    Ok,
+    Failed
+  };
+
+  Ds18b20():
+    addr_{},
+    raw_{},
+    bits_(12U),
+    found_(0U),
+    probe_(0U),
+    step_(Step::Idle),
+    convert_ms_(0U),
+    health_(0U),
+    reported_(0U)
+  {}
+
+  // Finds the first N DS18B20s on the bus and programs them; false if there are
+  // fewer than QUORUM.
+  bool Begin(uint8_t const bits, int8_t const alarm_hi, int8_t const alarm_lo)
+  {
+    OneWire wire(Pin);
+    bits_ = bits < 9U ? 9U : (bits > 12U ? 12U : bits);
+    found_ = 0U;
+    step_ = Step::Idle;
+    wire.reset_search();
+    while(found_ < N && wire.search(addr_[found_]))
+    {
+      if(addr_[found_][0] == FAMILY && OneWire::crc8(addr_[found_], 7U) == addr_[found_][7]) ++found_;
+    }
+    if(found_ < QUORUM) return false;
+    for(uint8_t i{}; i < found_; ++i)
+    {
+      if(!WriteScratchpad(wire, addr_[i], alarm_hi, alarm_lo)) return false;
+    }
+    return true;
+  }
+
+  bool Found() const { return found_ >= QUORUM; }
+  uint8_t Count() const { return found_; }
+  uint8_t const* Address(uint8_t const probe) const { return addr_[probe]; }
+
+  // worst case conversion time at the configured resolution
+  unsigned long ConvertMs() const
+  {
+    return 750UL >> (12U - bits_); // SENSOR_CONVERT_MS at bits_
+  }
+
+  // a reading is in progress
+  bool Busy() const { return step_ != Step::Idle; }
+
+  // Starts a reading; false when a probe is missing or one is still in progress.
+  bool Request()
+  {
+    if(!Found() || Busy()) return false;
+    step_ = Step::Convert;
+    return true;
+  }
+
+  // Every loop() pass. Ok (raw is the voted Temp16) or Failed once per Request():
+  // no presence, or fewer than QUORUM probes with a good CRC and a converted value.
+  Result Poll(int16_t& raw)
+  {
+    switch(step_)
+    {
+      case Step::Convert:
+      {
+        uint8_t const tx[]{ SKIP_ROM, CONVERT_T };
+        if(OwEngine::Start<Pin>(tx, sizeof(tx), 0U)) step_ = Step::Converting;
+        return Result::Pending;
+      }
+      case Step::Converting:
+      {
+        OwEngine::Status const s{ OwEngine::Collect(nullptr, 0U) };
+        if(s == OwEngine::Status::Busy) return Result::Pending;
+        if(s != OwEngine::Status::Done) return Fail();
+        convert_ms_ = static_cast<uint16_t>(millis());
+        probe_ = 0U;
+        health_ = 0U;
+        step_ = Step::Waiting;
+        return Result::Pending;
+      }
+      case Step::Waiting:
+        if(static_cast<uint16_t>(static_cast<uint16_t>(millis()) - convert_ms_) >= ConvertMs() && SendRead())
+          step_ = Step::Reading;
+        return Result::Pending;
+      case Step::Reading:
+      {
+        uint8_t sp[SCRATCHPAD];
+        OwEngine::Status const s{ OwEngine::Collect(sp, SCRATCHPAD) };
+        if(s == OwEngine::Status::Busy) return Result::Pending;
+        if(s == OwEngine::Status::Done && Decode(sp, raw_[probe_])) health_ |= static_cast<uint8_t>(1U << probe_);
+        if(++probe_ < found_)
+        {
+          step_ = SendRead() ? Step::Reading : Step::Waiting;
+          return Result::Pending;
+        }
+        step_ = Step::Idle;
+        if(Answered() < QUORUM) return Result::Failed;
+        raw = Vote();
+        return Result::Ok;
+      }
+      default:
+        return Result::Idle;
+    }
+  }
+
+  // Of the last good reading: false when no majority of the probes agreed.
+  bool Agreed() const { return !(health_ & SPLIT); }
+  // bit per probe that answered
+  uint8_t AnsweredMask() const { return static_cast<uint8_t>(health_ & ANSWERED); }
+  // the probe left out of the vote, NO_PROBE if none
+  uint8_t Outlier() const
+  {
+    uint8_t const o{ static_cast<uint8_t>((health_ & OUTLIER) >> 3) };
+    return o == 0U ? NO_PROBE : static_cast<uint8_t>(o - 1U);
+  }
+  // true once each time the answered probes, the outlier or the agreement differ
+  // from the reading before
+  bool HealthChanged()
+  {
+    if(health_ == reported_) return false;
+    reported_ = health_;
+    return true;
+  }
+
+  // Setup-time only, like Begin(): these go over the blocking OneWire.
+  bool SetAlarms(int8_t const hi, int8_t const lo)
+  {
+    OneWire wire(Pin);
+    for(uint8_t i{}; i < found_; ++i)
+    {
+      if(!WriteScratchpad(wire, addr_[i], hi, lo)) return false;
+    }
+    return true;
+  }
+  // true while the last conversion of any probe is outside TH/TL
+  bool Alarmed()
+  {
+    OneWire wire(Pin);
+    uint8_t addr[8];
+    wire.reset_search();
+    while(wire.search(addr, false))
+    {
+      for(uint8_t i{}; i < found_; ++i)
+      {
+        if(memcmp(addr, addr_[i], sizeof(addr)) == 0) return true;
+      }
+    }
+    return false;
+  }
+
+private:
+  enum class Step : uint8_t
+  {
+    Idle,
+    Convert,    // waiting for the bus
+    Converting, // CONVERT T on the bus
+    Waiting,    // conversion time, then READ SCRATCHPAD of probe_ once the bus is free
+    Reading     // READ SCRATCHPAD of probe_ on the bus
+  };
+
+  static constexpr uint8_t SKIP_ROM = 0xCCU;
+  static constexpr uint8_t MATCH_ROM = 0x55U;
+  static constexpr uint8_t CONVERT_T = 0x44U;
+  static constexpr uint8_t WRITE_SCRATCHPAD = 0x4EU;
+  static constexpr uint8_t READ_SCRATCHPAD = 0xBEU;
+  static constexpr uint8_t COPY_SCRATCHPAD = 0x48U;
+  static constexpr uint8_t SCRATCHPAD = 9U;
+  static constexpr unsigned long COPY_MS = 10UL;
+  static constexpr int16_t DISAGREE_RAW = TempToRaw(PROBE_DISAGREE_C);
+
+  // health_: ANSWERED bit per probe, OUTLIER its index + 1, SPLIT no majority
+  static constexpr uint8_t ANSWERED = 0x07U;
+  static constexpr uint8_t OUTLIER = 0x18U;
+  static constexpr uint8_t SPLIT = 0x20U;
+
+  // An open bus reads all ones and a shorted one all zeros; all zeros even has a
+  // good CRC. The config register's fixed bits (0RR11111) catch both.
+  static bool Valid(uint8_t const (&sp)[SCRATCHPAD])
+  {
+    return OneWire::crc8(sp, SCRATCHPAD - 1U) == sp[SCRATCHPAD - 1U] && (sp[4] & 0x9FU) == 0x1FU;
+  }
+  bool Decode(uint8_t const (&sp)[SCRATCHPAD], int16_t& raw) const
+  {
+    if(!Valid(sp)) return false;
+    // 85 C is what the scratchpad holds after the sensor lost power, i.e. nothing
+    // was converted; no enclosure here is meant to get anywhere near it
+    if(sp[0] == 0x50U && sp[1] == 0x05U) return false;
+    // bits below the resolution are undefined
+    uint8_t const lsb{ static_cast<uint8_t>(sp[0] & static_cast<uint8_t>(0xFFU << (12U - bits_))) };
+    raw = static_cast<int16_t>((static_cast<uint16_t>(sp[1]) << 8) | lsb);
+    return true;
+  }
+  uint8_t Answered() const
+  {
+    uint8_t n{};
+    for(uint8_t i{}; i < N; ++i) n = static_cast<uint8_t>(n + ((health_ >> i) & 1U));
+    return n;
+  }
+  static int16_t Apart(int16_t const a, int16_t const b)
+  {
+    return static_cast<int16_t>(a > b ? a - b : b - a);
+  }
+  // Over the probes that answered. Median: the middle of three, the mean of two
+  // (rounded down). Max: the hottest, so a low reading can never make the zone
+  // heat more. Either way without the outlier, the probe further than
+  // DISAGREE_RAW from the middle one while the third is not.
+  int16_t Vote()
+  {
+    uint8_t p[3];
+    uint8_t n{};
+    for(uint8_t i{}; i < N; ++i)
+    {
+      if(health_ & (1U << i)) p[n++] = i;
+    }
+    if(n == 1U) return raw_[p[0]];
+    if(n == 2U)
+    {
+      int16_t const a{ raw_[p[0]] }, b{ raw_[p[1]] };
+      if(Apart(a, b) > DISAGREE_RAW) health_ |= SPLIT;
+      if(PROBE_VOTE == ProbeVote::Max) return a > b ? a : b;
+      return static_cast<int16_t>((static_cast<int32_t>(a) + b) >> 1);
+    }
+    // three: order them, ties included
+    for(uint8_t i{}; i < 2U; ++i)
+    {
+      for(uint8_t j{ static_cast<uint8_t>(i + 1U) }; j < 3U; ++j)
+      {
+        if(raw_[p[j]] < raw_[p[i]]) { uint8_t const t{ p[i] }; p[i] = p[j]; p[j] = t; }
+      }
+    }
+    int16_t const lo{ raw_[p[0]] }, mid{ raw_[p[1]] }, hi{ raw_[p[2]] };
+    bool const lo_off{ Apart(mid, lo) > DISAGREE_RAW };
+    bool const hi_off{ Apart(hi, mid) > DISAGREE_RAW };
+    if(lo_off && hi_off) health_ |= SPLIT;
+    else if(lo_off) health_ |= static_cast<uint8_t>((p[0] + 1U) << 3);
+    else if(hi_off) health_ |= static_cast<uint8_t>((p[2] + 1U) << 3);
+    if(PROBE_VOTE == ProbeVote::Max) return hi_off ? mid : hi;
+    return mid;
+  }
+  Result Fail()
+  {
+    step_ = Step::Idle;
+    return Result::Failed;
+  }
+  bool SendRead()
+  {
+    uint8_t tx[OwEngine::MAX_BYTES];
+    tx[0] = MATCH_ROM;
+    memcpy(tx + 1, addr_[probe_], sizeof(addr_[probe_]));
+    tx[9] = READ_SCRATCHPAD;
+    return OwEngine::Start<Pin>(tx, sizeof(tx), SCRATCHPAD);
+  }
+
+  static bool Select(OneWire& wire, uint8_t const* addr)
+  {
+    if(!wire.reset()) return false;
+    wire.select(addr);
+    return true;
+  }
+  static bool ReadScratchpad(OneWire& wire, uint8_t const* addr, uint8_t (&sp)[SCRATCHPAD])
+  {
+    if(!Select(wire, addr)) return false;
+    wire.write(READ_SCRATCHPAD);
+    wire.read_bytes(sp, SCRATCHPAD);
+    return Valid(sp);
+  }
+  // TH, TL and resolution; copied to the sensor's EEPROM only when they differ so
+  // a reboot loop does not wear it
+  bool WriteScratchpad(OneWire& wire, uint8_t const* addr, int8_t const hi, int8_t const lo)
+  {
+    uint8_t const config{ static_cast<uint8_t>(((bits_ - 9U) << 5) | 0x1FU) };
+    uint8_t sp[SCRATCHPAD];
+    if(!ReadScratchpad(wire, addr, sp)) return false;
+    if(static_cast<int8_t>(sp[2]) == hi && static_cast<int8_t>(sp[3]) == lo && sp[4] == config) return true;
+
+    if(!Select(wire, addr)) return false;
+    wire.write(WRITE_SCRATCHPAD);
+    wire.write(static_cast<uint8_t>(hi));
+    wire.write(static_cast<uint8_t>(lo));
+    wire.write(config);
+    if(!Select(wire, addr)) return false;
+    wire.write(COPY_SCRATCHPAD);
+    delay(COPY_MS); // only ever from setup() or a recovery search; the sensor ignores the bus meanwhile
+    return true;
+  }
+
+  uint8_t addr_[N][8];
+  int16_t raw_[N];
+  uint8_t bits_;
+  uint8_t found_;
+  uint8_t probe_;
+  Step step_;
+  uint16_t convert_ms_; // low bits of millis(), conversions are well under a minute
+  uint8_t health_;      // of the reading in progress or the last one
+  uint8_t reported_;    // health_ as of the last HealthChanged()
+};
+
+// -----------------------------------------------------------------------------
+// Temp Controller
+// -----------------------------------------------------------------------------
+
+// TempController<I>: the zone in ZONES[I]. Uid and pins are folded in as constants,
+// so the relay switches with a single sbi/cbi. Thresholds come from Config::Zone(I)
+// and are compared as Temp16 raw integers.
+template<uint8_t I>
+class TempController
+{
+public:
+  static constexpr uint8_t UID = ZONES[I].uid;
+  static constexpr float MAX_C = ZONES[I].max_c; // ceiling; Config can only go lower
+  static_assert(Config::DefaultValid<I>(), "ZONES entry fails Config's range checks");
+private:
+  using Relay = PinDriver<ZONES[I].relay_pin>;
+  using Sensor = Ds18b20<ZONES[I].sensor_pin, ZONES[I].probes>;
+  static constexpr uint8_t FLAP_READMITTED = 0x80U; // flaps_: readmitted since the last fault
+  static constexpr uint8_t FLAP_COUNT = 0x7FU;
+  enum State
+  {
+    HEATING,
+    COOLING,
+    OFF,
+    FAULT // this zone only, see Fault()
+  };
+  class DesyncMan
+  {
+  public:
+    DesyncMan(): 
+      start_time_(),
+      start_raw_(),
+      max_raw_(),
+      not_inited_(true)
+      {}
+
+    void Reset() { not_inited_ = true; }
+    bool Update(int16_t const raw, ZoneSettings const& cfg)
+    {
+      if(not_inited_)
+      {
+        start_time_ = millis();
+        max_raw_ = start_raw_ = raw;
+        not_inited_ = false;
+        return false;
+      }
+      if(raw > max_raw_)
+      {
+        max_raw_ = raw;
+      }
+      if(millis() - start_time_ < cfg.rise_wait_s * 1000UL)
+      {
+        return false;
+      }
+      return (max_raw_ - start_raw_) < cfg.rise_raw;
+    }
+  private:
+    unsigned long start_time_;
+    int16_t start_raw_;
+    int16_t max_raw_;
+    bool not_inited_;
+  };
+public:
+  //anything should be able to turn it off but not on
+  TempController():
+    disconnect_streak_(0U),
+    st_(TempController::COOLING),
+    heater_is_off_(true),
+    fault_(PanicReason::None),
+    fault_ms_(0UL),
+    lost_(false),
+    good_streak_(0U),
+    retry_exp_(0U),
+    retry_ms_(0UL),
+    flaps_(0U),
+    sensor_(),
+    supervisor_slot_(Supervisor::NO_SLOT),
+    wdt_task_(0U),
+    last_raw_(0),
+    report_state_(true),
+    desync_man_(),
+    stats_()
+  { }
+  ~TempController()=default;
+  void Begin()
+  {
+    Relay::Drive(RELAY_INACTIVE_STATE);
+    if(!FindSensor() || sensor_.Count() < ZONES[I].probes)
+    {
+      SensorLog::println(LOG_STR("CTRL: "), UID, LOG_STR(" found "), sensor_.Count(), LOG_STR(" of "),
+                         ZONES[I].probes, LOG_STR(" DS18B20"));
+    }
+    stats_.Restart(millis());
+
+    supervisor_slot_ = Supervisor::Register(UID, MAX_C, &Relay::Drive);
+    wdt_task_ = Watchdog::RegisterTask();
+    if(supervisor_slot_ == Supervisor::NO_SLOT || wdt_task_ == 0U)
+    {
+      PANIC(UID, PanicReason::Other);
+    }
+  }
+  // L: CtrlLog for the periodic output, SysLog when answering the Console
+  template<typename L = CtrlLog>
+  void PrintState(int16_t const raw)
+  {
+    if(!L::enabled()) return;
+    if(TELEMETRY != TelemetryMode::Text)
+    {
+      Telemetry::SendState(UID, raw, static_cast<uint8_t>(st_), IsHeating());
+      return;
+    }
+
+    L::print(LOG_STR("CTRL: "), UID, LOG_STR(" Temp: "), Temp16{ raw });
+    switch(st_)
+    {
+      case HEATING:
+        L::print(LOG_STR(" ST: HEATING"));
+        break;
+      case COOLING:
+        L::print(LOG_STR(" ST: COOLING"));
+        break;
+      case OFF:
+        L::print(LOG_STR(" ST: OFF"));
+        break;
+      case FAULT:
+        L::print(LOG_STR(" ST: FAULT"));
+        break;
+      default:
+        break;
+    }
+    L::print(LOG_STR("\n"));
+  }
+  template<typename L = CtrlLog>
+  void PrintStats(WindowSummary const& w)
+  {
+    if(!L::enabled()) return;
+    if(TELEMETRY != TelemetryMode::Text)
+    {
+      Telemetry::SendStats(UID, w);
+      return;
+    }
+
+    L::print(LOG_STR("STAT: "), UID, LOG_STR(" n="), w.samples,
+             LOG_STR(" min="), Temp16{ w.min_raw }, LOG_STR(" mean="), Temp16{ w.mean_raw },
+             LOG_STR(" max="), Temp16{ w.max_raw });
+    L::println(LOG_STR(" duty="), w.duty_permille / 10U, '.', w.duty_permille % 10U,
+               LOG_STR("% sw="), w.transitions);
+  }
+  // Console queries: the current window so far, without restarting it
+  void PrintStatus()
+  {
+    ZoneSettings const& cfg{ Config::Zone(I) };
+    PrintState<SysLog>(last_raw_);
+    SysLog::println(LOG_STR("  target "), Temp16{ cfg.target_raw }, LOG_STR(" max "), Temp16{ cfg.max_raw },
+                    LOG_STR(" heater "), IsHeating() ? LOG_STR("ON") : LOG_STR("OFF"));
+  }
+  void PrintConfig()
+  {
+    Config::Print(UID, I);
+  }
+  // Console "set": false (and unchanged) when outside Config's range checks
+  bool Configure(Config::Key const key, int16_t const value)
+  {
+    return Config::SetZone(I, TempToRaw(MAX_C), key, value);
+  }
+  void PrintWindow()
+  {
+    PrintStats<SysLog>(stats_.Close(millis(), IsHeating()));
+  }
+
+  void Off()
+  {
+    //apparently bad
+    // if(heater_is_off_ == true) return;
+
+    Relay::Drive(RELAY_INACTIVE_STATE);
+    if(Panic::IsPanic() && st_ != FAULT)
+    {
+      st_ = OFF;
+    }
+    if(!heater_is_off_) stats_.HeaterOff(millis());
+    heater_is_off_ = true;
+  }
+  // last good sample, Temp16 raw; 0 before the first one
+  int16_t LastRaw() const
+  {
+    return last_raw_;
+  }
+  bool IsHeating() const
+  {
+    return !heater_is_off_;
+  }
+  bool IsFaulted() const
+  {
+    return st_ == FAULT;
+  }
+  // Console "panic"
+  void PrintFault()
+  {
+    if(st_ != FAULT) return;
+    SysLog::print(LOG_STR("FAULT: ")); SysLog::print(UID); SysLog::print(' ');
+    SysLog::print(PanicReasonStr(fault_));
+    SysLog::println(LOG_STR(" for "), (millis() - fault_ms_) / 1000UL, LOG_STR(" s"));
+  }
+  void Update(int16_t const raw)
+  {
+    if(st_ == OFF || st_ == FAULT) return;
+    ZoneSettings const& cfg{ Config::Zone(I) };
+    if(raw >= cfg.max_raw)
+    {
+      Fault(PanicReason::OverMax, __LINE__);
+      return;
+    }
+
+    if(st_ == HEATING)
+    {
+      if(desync_man_.Update(raw, cfg))
+      {
+        Fault(PanicReason::DesyncNoRise, __LINE__);
+        return;
+      }
+      if(raw >= cfg.target_raw + cfg.hyst_raw)
+      {
+        Off();
+        st_ = COOLING;
+      }
+    }
+    else if(st_ == COOLING && raw <= cfg.target_raw - cfg.hyst_raw)
+    {
+      desync_man_.Reset();
+      On();
+      st_ = HEATING;
+    }
+  }
+
+  // Every read interval: request a reading, Poll() picks the result up.
+  void Loop()
+  {
+    if(Panic::IsPanic()) return;
+    if(lost_)
+    {
+      // nothing to read until Rediscover() finds the sensor again
+      Watchdog::CheckIn(wdt_task_);
+      return;
+    }
+    // one still in progress a whole interval later (the bus never came free, or
+    // Timer1 is not running) is a lost sample; it is left to finish, not restarted
+    if(!sensor_.Request())
+    {
+      Sample(false, 0);
+    }
+  }
+
+  // Every loop() pass: moves the reading along. Runs during a panic as well so a
+  // transaction already on the bus still completes and frees it.
+  void Poll()
+  {
+    int16_t raw{};
+    typename Sensor::Result r;
+    {
+      Prof::Scope const scope{ ProfSection::SensorRead };
+      r = sensor_.Poll(raw);
+    }
+    if(Panic::IsPanic()) return;
+    if(r == Sensor::Result::Ok || r == Sensor::Result::Failed)
+    {
+      Sample(r == Sensor::Result::Ok, raw);
+    }
+    if(lost_) Rediscover();
+  }
+
+private:
+  void Sample(bool const ok, int16_t const raw)
+  {
+    Prof::Scope const scope{ ProfSection::Control };
+    Watchdog::CheckIn(wdt_task_);
+
+    if(!ok)
+    {
+      if(disconnect_streak_ < 0xFFU) ++disconnect_streak_;
+      if(disconnect_streak_ >= 2U && st_ != FAULT)
+      {
+        Fault(PanicReason::SensorDisconnected, __LINE__);
+        SensorLog::println(LOG_STR("CTRL: "), UID, LOG_STR("Heater -> OFF (fail-safe)"));
+      }
+      else if(Recovering())
+      {
+        // back from the start, after a fresh search
+        good_streak_ = 0U;
+        lost_ = true;
+      }
+    }
+    else
+    {
+      last_raw_ = raw;
+      Panic::MarkSample(raw);
+      disconnect_streak_ = 0U;
+      Supervisor::Feed(supervisor_slot_, raw);
+      // decide first: formatting and logging should not sit between an
+      // over-max sample and the relay going off
+      State const before{ st_ };
+      if(!sensor_.Agreed())
+      {
+        Fault(PanicReason::ProbeDisagree, __LINE__);
+      }
+      else if(Recovering() && ++good_streak_ >= RECOVERY_SAMPLES)
+      {
+        Readmit();
+      }
+      this->Update(raw);
+      stats_.Add(raw);
+
+      report_state_ |= (st_ != before);
+      if(report_state_ || STATS_WINDOW_MS == 0UL)
+      {
+        this->PrintState(raw);
+        report_state_ = false;
+      }
+      if(ZONES[I].probes > 1U && sensor_.HealthChanged()) PrintProbes();
+
+      unsigned long const now{ millis() };
+      if(STATS_WINDOW_MS != 0UL && stats_.Due(now))
+      {
+        this->PrintStats(stats_.Close(now, IsHeating()));
+        stats_.Restart(now);
+      }
+    }
+  }
+  // "CTRL: <uid> probes 1 ok 2 outlier 3 missing", on every change
+  void PrintProbes()
+  {
+    uint8_t const answered{ sensor_.AnsweredMask() };
+    SensorLog::print(LOG_STR("CTRL: "), UID, LOG_STR(" probes"));
+    for(uint8_t i{}; i < sensor_.Count(); ++i)
+    {
+      LogStr const what{ !(answered & (1U << i)) ? LOG_STR(" missing")
+                       : (i == sensor_.Outlier() ? LOG_STR(" outlier") : LOG_STR(" ok")) };
+      SensorLog::print(' ', static_cast<uint8_t>(i + 1U), what);
+    }
+    if(!sensor_.Agreed()) SensorLog::print(LOG_STR(", no majority"));
+    SensorLog::println();
+  }
+  // Heater off, then either the global PANIC or, for a zone scoped reason, this
+  // zone alone latched in FAULT: isolated from the supervisor's staleness check
+  // and left to keep sampling (watchdog check-ins, the state line), never heating.
+  void Fault(PanicReason const reason, uint16_t const line)
+  {
+    Off();
+    if(!Panic::IsZoneScoped(reason))
+    {
+      Panic::StartPanic(reason, UID, line);
+      return;
+    }
+    // a zone recovering from a lost sensor can still fault for good
+    if(st_ == FAULT && !Recovering()) return;
+    unsigned long const now{ millis() };
+    // fault_ms_ is the readmission time while FLAP_READMITTED is set
+    bool const flapping{ (flaps_ & FLAP_READMITTED) && reason == PanicReason::SensorDisconnected
+                         && now - fault_ms_ < SENSOR_FLAP_QUIET_MS };
+    uint8_t const repeats{ static_cast<uint8_t>(flaps_ & FLAP_COUNT) };
+    flaps_ = flapping ? static_cast<uint8_t>(repeats < FLAP_COUNT ? repeats + 1U : repeats) : 0U;
+    st_ = FAULT;
+    fault_ = reason;
+    fault_ms_ = now;
+    Supervisor::Isolate(supervisor_slot_);
+    Panic::ZoneFault(reason, UID, line, flaps_);
+    if(Recovering())
+    {
+      lost_ = true;
+      good_streak_ = 0U;
+      retry_exp_ = 0U;
+      retry_ms_ = fault_ms_;
+    }
+  }
+  // only a lost sensor heals by itself; a probe that came off the enclosure
+  // (no rise) or an over max needs someone to look at it
+  bool Recovering() const
+  {
+    return SENSOR_RECOVERY && st_ == FAULT && fault_ == PanicReason::SensorDisconnected;
+  }
+  // TH at the max: the sensor's alarm flag then means over max on its own; TL off
+  bool FindSensor()
+  {
+    return sensor_.Begin(SENSOR_BITS, static_cast<int8_t>(MAX_C), -55);
+  }
+  unsigned long RetryMs() const
+  {
+    unsigned long const ms{ SENSOR_RETRY_MIN_MS << retry_exp_ };
+    return ms < SENSOR_RETRY_MAX_MS ? ms : SENSOR_RETRY_MAX_MS;
+  }
+  // Resets and searches the bus for the lost sensor once RetryMs() has passed,
+  // the wait doubling with every attempt until the zone is readmitted. Only with
+  // the bus idle: the search is OneWire's, with interrupts off for every bit.
+  void Rediscover()
+  {
+    unsigned long const now{ millis() };
+    if(sensor_.Busy() || !OwEngine::IsIdle() || now - retry_ms_ < RetryMs()) return;
+    retry_ms_ = now;
+    if(RetryMs() < SENSOR_RETRY_MAX_MS) ++retry_exp_;
+    if(FindSensor())
+    {
+      lost_ = false;
+      SensorLog::println(LOG_STR("CTRL: "), UID, LOG_STR(" sensor found, "), RECOVERY_SAMPLES,
+                         LOG_STR(" good samples to go"));
+    }
+    else
+    {
+      SensorLog::println(LOG_STR("CTRL: "), UID, LOG_STR(" no sensor, next try in "), RetryMs() / 1000UL,
+                         LOG_STR(" s"));
+    }
+  }
+  // RECOVERY_SAMPLES good samples in a row since the sensor came back
+  void Readmit()
+  {
+    SensorLog::println(LOG_STR("CTRL: "), UID, LOG_STR(" recovered after "), (millis() - fault_ms_) / 1000UL,
+                       LOG_STR(" s"));
+    st_ = COOLING;
+    fault_ = PanicReason::None;
+    disconnect_streak_ = 0U;
+    good_streak_ = 0U;
+    retry_exp_ = 0U;
+    flaps_ |= FLAP_READMITTED;
+    fault_ms_ = millis(); // the SENSOR_FLAP_QUIET_MS window starts here
+    desync_man_.Reset();
+    Supervisor::Readmit(supervisor_slot_);
+  }
+  inline void On()
+  {
+    if(heater_is_off_ == false) return;
+
+    Relay::Drive(RELAY_ACTIVE_STATE);
+    stats_.HeaterOn(millis());
+    heater_is_off_ = false;
+  }
+private:
+  uint8_t disconnect_streak_;
+  State st_;
+  bool heater_is_off_;
+  PanicReason fault_;
+  unsigned long fault_ms_; // in FAULT since; otherwise the last readmission
+  bool lost_;           // recovering, no sensor on the bus: see Rediscover()
+  uint8_t good_streak_; // recovering, good samples since it was found
+  uint8_t retry_exp_;
+  unsigned long retry_ms_;
+  uint8_t flaps_;       // FLAP_READMITTED | repeats of a flapping sensor fault
+  Sensor sensor_;
+  uint8_t supervisor_slot_;
+  Watchdog::TaskMask wdt_task_;
+  int16_t last_raw_;
+  bool report_state_;
+  DesyncMan desync_man_;
+  WindowStats stats_;
+};
+
+
+// -----------------------------------------------------------------------------
+// Console
+// -----------------------------------------------------------------------------
+// Console: line based commands from the PC, one line per '\n' (a '\r' is ignored).
+// Poll() only takes what Serial already holds, so control never waits on it; the
+// line lives in a fixed buffer and is split in place, no String, no heap.
+//
+//   state                  every zone's last sample, target, max and heater
+//   stats                  every zone's stats window so far
+//   config                 the runtime settings (see Config)
+//   set <uid> <key> <v>    change one: target|max|hyst|rise in C, wait in s,
+//                          e.g. "set 1 target 24.5"
+//   set interval <ms>      change the read interval
+//   defaults               back to the compiled settings
+//   mem                    free RAM now and its low-water mark (see Memory)
+//   energy                 per zone Wh this hour, today and in total (see Energy)
+//   panic                  the latched panic in full
+//   journal | history      dump the panic journal / the temperature history
+//   log [mask|all]         show or set the LogSys mask (bit n = LogSys n)
+//
+// Replies go out on SysLog; errors start with "ERR". The per-zone replies (state,
+// stats, config, panic) are queued and Update() sends one zone per loop() pass
+// while Log has room for it, like the journal and history dumps.
+
+class Console
 {
-private:
-  enum State
-  {
-    HEATING,
-    COOLING,
-    OFF
-  };
-  class DesyncMan
-  {
-  private:
-    static constexpr float NEEDED_TEMP_CHANGE = 0.25f;
-    static constexpr unsigned long TIME_TO_WAIT = 300000UL;
-  public:
-    DesyncMan(): 
-      start_time_(),
-      start_temp_(),
-      max_temp_(),
-      not_inited_(true)
-      {}
+public:
+  static constexpr uint8_t LINE = 24U;
 
-    void Reset() { not_inited_ = true; }
-    bool Update(float const temp_c)
+  enum class Show : uint8_t { State, Stats, Config, Faults };
+  enum class SetResult : uint8_t { NoZone, OutOfRange, Ok };
+
+  // Call every loop().
+  static void Poll()
+  {
+    while(Serial.available() > 0)
     {
-      if(not_inited_)
-      {
-        start_time_ = millis();
-        max_temp_ = start_temp_ = temp_c;
-        not_inited_ = false;
-        return false;
-      }
-      if(temp_c > max_temp_)
-      {
-        max_temp_ = temp_c;
-      }
-      if(millis() - start_time_ < TIME_TO_WAIT)
+      char const c{ static_cast<char>(Serial.read()) };
+      if(c == '\r') continue;
+      if(c != '\n')
       {
-        return false;
+        if(len_ < LINE - 1U) line_[len_++] = c;
+        else overflow_ = true;
+        continue;
       }
-      return (max_temp_ - start_temp_) < NEEDED_TEMP_CHANGE;
+
+      line_[len_] = '\0';
+      if(!CONNECT_TO_PC) Offline();
+      else if(overflow_) SysLog::println(LOG_STR("ERR: line too long"));
+      else if(len_ != 0U) Execute();
+      len_ = 0U;
+      overflow_ = false;
     }
-  private:
-    unsigned long start_time_;
-    float start_temp_;
-    float max_temp_;
-    bool not_inited_;
-  };
-public:
-  //anything should be able to turn it off but not on
-  TempController()=delete;
-  TempController(uint8_t const uid, float const target, float const max, uint8_t sen_wire_pin, uint8_t relay_pin):
-    uid_(uid),
-    disconnect_streak_(0U),
-    st_(TempController::COOLING),
-    heater_is_off_(true),
-    target_(target),
-    max_(max),
-    one_wire_(sen_wire_pin),
-    sensor_(&one_wire_),
-    relay_pin_(relay_pin),
-    desync_man_()
-  { }
-  ~TempController()=default;
-  void Begin()
-  {
-    pinMode(relay_pin_, OUTPUT);
-    digitalWrite(relay_pin_, RELAY_INACTIVE_STATE);
-    sensor_.begin();
   }
-  void PrintState(float const temp_c)
+
+  // Call regularly from loop(); emits at most one zone of a pending reply.
+  static void Update()
   {
-    Log::print(F("CTRL: "), uid_, F(" Temp: "), temp_c);
-    switch(st_)
+    if(cursor_ == 0U) return;
+    if(!SysLog::enabled())
     {
-      case HEATING:
-        Log::print(F(" ST: HEATING"));
-        break;
-      case COOLING:
-        Log::print(F(" ST: COOLING"));
-        break;
-      case OFF:
-        Log::print(F(" ST: OFF"));
-        break;
-      default:
-        break;
+      cursor_ = 0U;
+      return;
     }
-    Log::print(F("\n"));
-  }
-  void Off()
-  {
-    //apparently bad
-    // if(heater_is_off_ == true) return;
+    if(Log::room() < LINE_ROOM) return;
 
-    digitalWrite(relay_pin_, RELAY_INACTIVE_STATE);
-    if(Panic::IsPanic())
+    if(show_ == Show::Config && cursor_ == 1U)
     {
-      st_ = OFF;
+      Config::PrintSource();
+      Config::PrintInterval();
+      ++cursor_;
+      return;
     }
-    heater_is_off_ = true;
+
+    uint8_t const zone{ static_cast<uint8_t>(cursor_ - (show_ == Show::Config ? 2U : 1U)) };
+    if(zone >= ZONE_COUNT)
+    {
+      cursor_ = 0U;
+      return;
+    }
+    ++cursor_;
+    PrintZone(show_, zone);
   }
-  bool IsHeating() const
+
+private:
+  static constexpr uint8_t MAX_ARGS = 4U;
+  static constexpr uint8_t LINE_ROOM = 96U;
+
+  // Without CONNECT_TO_PC there is no Log to answer on, so the one command left
+  // is "history": the EEPROM record is the point of such a build.
+  static void Offline()
   {
-    return !heater_is_off_;
+    if(!overflow_ && strcmp_P(line_, PSTR("history")) == 0) History::DumpBlocking();
   }
-  void Update(float const current_temp_c)
+
+  static void Execute()
   {
-    if(st_ == OFF) return;
-    if(current_temp_c >= max_)
+    char* argv[MAX_ARGS]{};
+    uint8_t argc{};
+    char* p{ line_ };
+    while(*p != '\0' && argc < MAX_ARGS)
     {
-      PANIC(uid_, PanicReason::OverMax);
-      Off();
+      while(*p == ' ') *p++ = '\0';
+      if(*p == '\0') break;
+      argv[argc++] = p;
+      while(*p != '\0' && *p != ' ') ++p;
+    }
+    while(*p == ' ') *p++ = '\0';
+    if(argc == 0U) return;
+    if(*p != '\0')
+    {
+      SysLog::println(LOG_STR("ERR: too many arguments"));
       return;
     }
 
-    if(st_ == HEATING)
+    char const* const cmd{ argv[0] };
+    if(strcmp_P(cmd, PSTR("state")) == 0 && argc == 1U)
     {
-      if(desync_man_.Update(current_temp_c))
-      {
-        PANIC(uid_, PanicReason::DesyncNoRise);
-        Off();
-        return;
-      }
-      if(current_temp_c >= (target_ + TEMP_ALLOWANCE))
+      Reply(Show::State);
+    }
+    else if(strcmp_P(cmd, PSTR("stats")) == 0 && argc == 1U)
+    {
+      Reply(Show::Stats);
+    }
+    else if(strcmp_P(cmd, PSTR("config")) == 0 && argc == 1U)
+    {
+      Reply(Show::Config);
+    }
+    else if(strcmp_P(cmd, PSTR("set")) == 0 && argc >= 3U)
+    {
+      Set(argc, argv);
+    }
+    else if(strcmp_P(cmd, PSTR("defaults")) == 0 && argc == 1U)
+    {
+      Config::RestoreDefaults();
+      SysLog::println(LOG_STR("OK defaults"));
+    }
+    else if(strcmp_P(cmd, PSTR("mem")) == 0 && argc == 1U)
+    {
+      Memory::Print();
+    }
+    else if(strcmp_P(cmd, PSTR("energy")) == 0 && argc == 1U)
+    {
+      Energy::Print();
+    }
+    else if(strcmp_P(cmd, PSTR("panic")) == 0 && argc == 1U)
+    {
+      if(Panic::IsPanic()) Panic::RequestReport();
+      if(AnyFaulted()) Reply(Show::Faults);
+      else if(!Panic::IsPanic()) SysLog::println(LOG_STR("no panic"));
+    }
+    else if(strcmp_P(cmd, PSTR("journal")) == 0 && argc == 1U)
+    {
+      Journal::Dump();
+    }
+    else if(strcmp_P(cmd, PSTR("history")) == 0 && argc == 1U)
+    {
+      History::Dump();
+    }
+    else if(strcmp_P(cmd, PSTR("log")) == 0 && argc <= 2U)
+    {
+      uint16_t mask{};
+      if(argc == 2U)
       {
-        Off();
-        st_ = COOLING;
+        if(strcmp_P(argv[1], PSTR("all")) == 0) mask = 0xFFU;
+        else if(!ParseUint(argv[1], mask) || mask > 0xFFU)
+        {
+          SysLog::println(LOG_STR("ERR: mask 0..255"));
+          return;
+        }
+        Log::set_sys_mask(static_cast<uint8_t>(mask));
       }
+      SysLog::println(LOG_STR("log mask "), Log::sys_mask());
     }
-    else if(st_ == COOLING && current_temp_c <= (target_ - TEMP_ALLOWANCE))
+    else
     {
-      desync_man_.Reset();
-      On();
-      st_ = HEATING;
+      SysLog::println(LOG_STR("ERR: state|stats|config|set|defaults|mem|energy|panic|journal|history|log"));
     }
   }
 
-  void Loop()
+  static void Set(uint8_t const argc, char* const* const argv)
   {
-    if(Panic::IsPanic()) return;
-
-    sensor_.requestTemperatures();
-    float const temp_c{ sensor_.getTempCByIndex(0) };
+    if(argc == 3U && strcmp_P(argv[1], PSTR("interval")) == 0)
+    {
+      uint16_t ms{};
+      if(ParseUint(argv[2], ms) && Config::SetReadInterval(ms)) Config::PrintInterval();
+      else SysLog::println(LOG_STR("ERR: interval out of range"));
+      return;
+    }
 
-    if(temp_c == DEVICE_DISCONNECTED_C)
+    uint16_t uid{};
+    Config::Key key{};
+    int16_t value{};
+    if(argc != 4U || !ParseUint(argv[1], uid) || !ParseKey(argv[2], key) || !ParseValue(key, argv[3], value))
     {
-      if(++disconnect_streak_ >= 2U)
-      {
-        PANIC(uid_, PanicReason::SensorDisconnected);
-        Log::println(F("CTRL: "), uid_, F("Heater -> OFF (fail-safe)"));
-      }
+      SysLog::println(LOG_STR("ERR: set <uid> target|max|hyst|rise <C>|wait <s>"));
+      return;
     }
-    else
+    switch(SetZone(uid, key, value))
     {
-      disconnect_streak_ = 0U;
-      // Log::print(F("CTRL: "), uid_, F(" Temp: "), temp_c, F(" C\n"));
-      this->PrintState(temp_c);
-      this->Update(temp_c);
+      case SetResult::Ok:
+        break; // the zone printed its new settings
+      case SetResult::OutOfRange:
+        SysLog::println(LOG_STR("ERR: out of range"));
+        break;
+      default:
+        SysLog::println(LOG_STR("ERR: no zone "), uid);
+        break;
     }
   }
 
-private:
-  inline void On()
+  // A new command drops whatever is left of the previous reply.
+  static void Reply(Show const what)
   {
-    if(heater_is_off_ == false) return;
+    show_ = what;
+    cursor_ = 1U;
+  }
 
-    digitalWrite(relay_pin_, RELAY_ACTIVE_STATE);
-    heater_is_off_ = false;
+  // defined after the zones (Globals)
+  static void PrintZone(Show what, uint8_t zone); // zone: index into ZONES
+  static bool AnyFaulted();
+  static SetResult SetZone(uint16_t uid, Config::Key key, int16_t value);
+
+  static bool ParseKey(char const* const s, Config::Key& key)
+  {
+    if(strcmp_P(s, PSTR("target")) == 0)    key = Config::Key::Target;
+    else if(strcmp_P(s, PSTR("max")) == 0)  key = Config::Key::Max;
+    else if(strcmp_P(s, PSTR("hyst")) == 0) key = Config::Key::Hyst;
+    else if(strcmp_P(s, PSTR("rise")) == 0) key = Config::Key::Rise;
+    else if(strcmp_P(s, PSTR("wait")) == 0) key = Config::Key::RiseWait;
+    else return false;
+    return true;
+  }
+  // seconds for RiseWait, otherwise degrees C as Temp16 raw
+  static bool ParseValue(Config::Key const key, char const* const s, int16_t& out)
+  {
+    if(key == Config::Key::RiseWait)
+    {
+      uint16_t v{};
+      if(!ParseUint(s, v) || v > 0x7FFFU) return false;
+      out = static_cast<int16_t>(v);
+      return true;
+    }
+    int32_t centi{};
+    if(!ParseCenti(s, centi)) return false;
+    int32_t const x16{ centi * 16L };
+    out = static_cast<int16_t>((x16 + (x16 < 0 ? -50L : 50L)) / 100L); // |centi| < 100000 fits
+    return true;
+  }
+
+  // decimal, at most 5 digits
+  static bool ParseUint(char const* s, uint16_t& out)
+  {
+    uint32_t v{};
+    uint8_t digits{};
+    for(; *s >= '0' && *s <= '9'; ++s)
+    {
+      if(++digits > 5U) return false;
+      v = v * 10UL + static_cast<uint8_t>(*s - '0');
+    }
+    if(digits == 0U || *s != '\0' || v > 0xFFFFUL) return false;
+    out = static_cast<uint16_t>(v);
+    return true;
+  }
+  // "[-]d[dd][.d[d]]" in hundredths (999.99 does not fit an int16_t, hence 32
+  // bits); the range is Config::SetZone()'s to judge
+  static bool ParseCenti(char const* s, int32_t& out)
+  {
+    bool const neg{ *s == '-' };
+    if(neg) ++s;
+    int32_t v{};
+    uint8_t digits{};
+    for(; *s >= '0' && *s <= '9'; ++s)
+    {
+      if(++digits > 3U) return false;
+      v = v * 10L + (*s - '0');
+    }
+    if(digits == 0U) return false;
+    v *= 100L;
+    if(*s == '.')
+    {
+      ++s;
+      int8_t scale{ 10 };
+      for(; *s >= '0' && *s <= '9' && scale != 0; ++s, scale = static_cast<int8_t>(scale / 10))
+        v += (*s - '0') * scale;
+    }
+    if(*s != '\0') return false;
+    out = neg ? -v : v;
+    return true;
   }
-private:
-  uint8_t const uid_;
-  uint8_t disconnect_streak_;
-  State st_;
-  bool heater_is_off_;
-  float const target_;
-  float const max_;
-  OneWire one_wire_;
-  DallasTemperature sensor_;
-  uint8_t const relay_pin_;
-  DesyncMan desync_man_;
-};
 
+  static char line_[LINE];
+  static uint8_t len_;
+  static bool overflow_;
+  static Show show_;
+  static uint8_t cursor_; // Update(): 0 idle, else 1 + the next item
+};
 
 // -----------------------------------------------------------------------------
 // Globals
@@ -446,16 +3739,251 @@ private:
 bool Panic::is_panic_ = false;
 Panic::Callback Panic::callbacks_[Panic::MAX_CALLBACKS] = { 0 };
 unsigned char Panic::callback_count_ = 0U;
-PanicInfo Panic::panic_info_ = { 0UL, 0U, 0U, PanicReason::None };
+PanicInfo Panic::panic_info_ = { 0UL, 0U, 0U, PanicReason::None, 0U, 0 };
+uint8_t Journal::counts_[Journal::REASONS] = { 0 };
+uint16_t Journal::newest_seq_ = 0U;
+uint8_t Journal::newest_slot_ = Journal::SLOTS - 1U;
+uint8_t Journal::valid_ = 0U;
+uint8_t Journal::cursor_ = 0U;
+
+int16_t History::last_raw_[History::ZONES] = { 0 };
+uint16_t History::next_seq_ = 0U;
+uint8_t History::page_ = 0U;
+uint8_t History::pos_ = History::PAGE;
+uint8_t History::cursor_ = 0U;
+bool History::boot_ = true;
+
+uint32_t Energy::total_s_[Energy::ZONES] = { 0 };
+uint32_t Energy::hour_ms_[Energy::ZONES] = { 0 };
+uint32_t Energy::day_ms_[Energy::ZONES] = { 0 };
+unsigned long Energy::last_ms_ = 0UL;
+unsigned long Energy::hour_start_ms_ = 0UL;
+uint8_t Energy::heater_ = 0U;
+uint8_t Energy::hours_ = 0U;
+
+char Console::line_[Console::LINE] = { 0 };
+uint8_t Console::len_ = 0U;
+bool Console::overflow_ = false;
+Console::Show Console::show_ = Console::Show::State;
+uint8_t Console::cursor_ = 0U;
+
+Config::Record Config::rec_ = {};
+unsigned long Config::changed_ms_ = 0UL;
+bool Config::dirty_ = false;
+bool Config::from_eeprom_ = false;
+
+unsigned long Memory::last_check_ms_ = 0UL;
+bool Memory::warned_ = false;
+
+uint32_t Panic::sample_us_ = 0UL;
+int16_t Panic::sample_raw_ = 0;
+uint32_t Panic::last_report_ms_ = 0UL;
+uint32_t Panic::report_interval_ms_ = PANIC_REPORT_MIN_MS;
+uint8_t Panic::repeats_ = 0U;
+bool Panic::full_requested_ = false;
+
+Supervisor::Slot Supervisor::slots_[Supervisor::MAX_ZONES] = {};
+uint8_t Supervisor::count_ = 0U;
+volatile uint8_t Supervisor::tripped_mask_ = 0U;
+volatile uint8_t Supervisor::isolated_mask_ = 0U;
+
+uint8_t OwEngine::buf_[OwEngine::MAX_BYTES] = {};
+volatile uint8_t* OwEngine::ddr_ = nullptr;
+volatile uint8_t* OwEngine::in_ = nullptr;
+uint8_t OwEngine::mask_ = 0U;
+uint8_t OwEngine::tx_bits_ = 0U;
+uint8_t OwEngine::end_bit_ = 0U;
+uint8_t OwEngine::bit_ = 0U;
+OwEngine::Phase OwEngine::phase_ = OwEngine::Phase::ResetLow;
+volatile OwEngine::Status OwEngine::status_ = OwEngine::Status::Idle;
+
+// .noinit: must survive the watchdog reset, so the C runtime must not zero it
+Watchdog::Record Watchdog::record_ __attribute__((section(".noinit")));
+unsigned long Watchdog::fed_ms_ = 0UL;
+ResetCause Watchdog::reset_cause_ = ResetCause::Unknown;
+Watchdog::TaskMask Watchdog::missed_tasks_ = 0U;
+Watchdog::TaskMask Watchdog::registered_ = 0U;
+Watchdog::TaskMask Watchdog::next_task_ = 0x04U;
+volatile Watchdog::TaskMask Watchdog::checked_in_ = 0U;
 
 
-TempController const * LEDMan::controllers_[LEDMan::MAX_CONTROLLERS] = { nullptr };
-unsigned int LEDMan::num_controllers_ = 0U;
 
 unsigned int LEDMan::currentStateIndex_ = 0U;
 bool LEDMan::ledOn_ = false;
 unsigned long LEDMan::lastToggleMs_ = 0UL;
 
+uint8_t Logger<true>::sys_mask_ = 0xFFU;
+
+Profiler<true>::Stat Profiler<true>::stats_[static_cast<uint8_t>(ProfSection::COUNT)] = {};
+unsigned long Profiler<true>::last_report_ms_ = 0UL;
+
+LogStr ProfSectionStr(ProfSection s)
+{
+  switch (s)
+  {
+    case ProfSection::Loop:       return LOG_STR("loop");
+    case ProfSection::Control:    return LOG_STR("control");
+    case ProfSection::SensorRead: return LOG_STR("sensor");
+    case ProfSection::LogPrint:   return LOG_STR("log");
+    default:                      return LOG_STR("?");
+  }
+}
+
+void Profiler<true>::Update()
+{
+  unsigned long const now{ millis() };
+  if(now - last_report_ms_ < PROFILE_REPORT_MS) return;
+  last_report_ms_ = now;
+
+  // snapshot and reset first so the report's own prints land in the next window
+  Stat snap[static_cast<uint8_t>(ProfSection::COUNT)];
+  for(uint8_t i{}; i < static_cast<uint8_t>(ProfSection::COUNT); ++i)
+  {
+    snap[i] = stats_[i];
+    stats_[i] = Stat{};
+  }
+
+  SysLog::println(LOG_STR("PROF: section n min/mean/max us"));
+  for(uint8_t i{}; i < static_cast<uint8_t>(ProfSection::COUNT); ++i)
+  {
+    Stat const& st = snap[i];
+    uint32_t const mean{ st.count ? st.total_us / st.count : 0U };
+    SysLog::println(LOG_STR("PROF: "), ProfSectionStr(static_cast<ProfSection>(i)), LOG_STR(" "), st.count, LOG_STR(" "),
+                 st.min_us, LOG_STR("/"), mean, LOG_STR("/"), st.max_us);
+  }
+}
+
+template<uint8_t I> constexpr uint8_t TempController<I>::UID;
+template<uint8_t I> constexpr float TempController<I>::MAX_C;
+
+// One TempController<I> per ZONES entry. Each is its own type, so there is no
+// array to index: ForEach() calls a functor on every zone in table order.
+template<uint8_t I>
+struct ZoneLeaf
+{
+  TempController<I> zone;
+};
+
+template<typename Seq>
+struct ZoneSet;
+
+template<uint8_t... I>
+struct ZoneSet<IndexSeq<I...>> : ZoneLeaf<I>...
+{
+  static_assert(sizeof...(I) >= 1U, "ZONES is empty");
+
+  template<uint8_t J>
+  TempController<J>& Get() { return static_cast<ZoneLeaf<J>&>(*this).zone; }
+
+  template<typename F>
+  void ForEach(F f)
+  {
+    int const expand[] = { (f(Get<I>()), 0)... };
+    (void)expand;
+  }
+};
+
+ZoneSet<ZoneIndices> GZones;
+
+// SRAM budgets. The figures are avr-gcc ones (2 byte int and pointers, no padding),
+// so they only hold on the target; the Memory report is the runtime side of this.
+#if defined(__AVR__)
+static_assert(sizeof(TxRing) <= TxRing::SIZE + 12U, "TxRing grew beyond its buffer plus bookkeeping");
+static_assert(sizeof(Ds18b20<ZONES[0].sensor_pin, ZONES[0].probes>) <= 8U + 10U * ZONES[0].probes,
+              "Ds18b20 is an address and a reading per probe, the resolution and the reading state");
+static_assert(sizeof(TempController<0>) <= 8U + 10U * ZONES[0].probes + 56U, "TempController's own state outgrew 56 bytes per zone");
+static_assert(sizeof(GZones) <= ZONE_COUNT * (8U + 10U * 3U + 56U), "zones outgrew their budget");
+static_assert(sizeof(WindowStats) <= 24U, "WindowStats is kept per zone");
+#endif
+
+struct ZoneBegin
+{
+  template<typename Z> void operator()(Z& z) const { z.Begin(); }
+};
+struct ZoneLoop
+{
+  template<typename Z> void operator()(Z& z) const { z.Loop(); }
+};
+struct ZonePoll
+{
+  template<typename Z> void operator()(Z& z) const { z.Poll(); }
+};
+struct ZoneAnyHeating
+{
+  bool& any;
+  template<typename Z> void operator()(Z& z) const { any |= z.IsHeating(); }
+};
+struct ZoneAnyFaulted
+{
+  bool& any;
+  template<typename Z> void operator()(Z& z) const { any |= z.IsFaulted(); }
+};
+struct ZoneHeaterBits
+{
+  uint8_t& bits;
+  uint8_t next;
+  template<typename Z> void operator()(Z& z)
+  {
+    if(z.IsHeating()) bits |= next;
+    next = static_cast<uint8_t>(next << 1);
+  }
+};
+struct ZoneSample
+{
+  History::Sample* next;
+  template<typename Z> void operator()(Z& z)
+  {
+    next->raw = z.LastRaw();
+    next->heater = z.IsHeating();
+    ++next;
+  }
+};
+struct ZonePrint
+{
+  Console::Show what;
+  uint8_t zone;
+  template<typename Z> void operator()(Z& z) const
+  {
+    if(Z::UID != ZONES[zone].uid) return;
+    switch(what)
+    {
+      case Console::Show::Stats:  z.PrintWindow(); break;
+      case Console::Show::Config: z.PrintConfig(); break;
+      case Console::Show::Faults: z.PrintFault(); break;
+      default:                    z.PrintStatus(); break;
+    }
+  }
+};
+struct ZoneConfigure
+{
+  uint16_t uid;
+  Config::Key key;
+  int16_t value;
+  Console::SetResult& result;
+  template<typename Z> void operator()(Z& z) const
+  {
+    if(Z::UID != uid) return;
+    result = Console::SetResult::OutOfRange;
+    if(!z.Configure(key, value)) return;
+    result = Console::SetResult::Ok;
+    z.PrintConfig();
+  }
+};
+
+template<uint8_t I>
+void ZoneOff()
+{
+  GZones.Get<I>().Off();
+}
+
+// keeps each controller's own state in line with the relays Panic already dropped
+template<uint8_t... I>
+void InitPanicCallbacks(IndexSeq<I...>)
+{
+  Panic::Callback const cbs[] = { &ZoneOff<I>... };
+  Panic::Init(cbs);
+}
+
 void LEDMan::UpdateState()
 {
   //thematically, setting the unset value to something invalid, impossible to use
@@ -467,35 +3995,44 @@ void LEDMan::UpdateState()
   }
   else
   {
+    bool any_faulted { false };
     bool any_heating { false };
-
-    for(unsigned int i{}; i < num_controllers_; ++i)
-    {
-      any_heating |= controllers_[i]->IsHeating();
-    }
-    new_state = any_heating ? 1U : 2U;
+    GZones.ForEach(ZoneAnyFaulted{ any_faulted });
+    GZones.ForEach(ZoneAnyHeating{ any_heating });
+    new_state = any_faulted ? 3U : (any_heating ? 1U : 2U);
   }
 
   if(new_state != currentStateIndex_)
   {
+    LedLog::println(LOG_STR("LED: state "), new_state);
     currentStateIndex_ = new_state;
     ledOn_ = true;
     lastToggleMs_ = millis();
   }
 }
 
+void Console::PrintZone(Show const what, uint8_t const zone)
+{
+  GZones.ForEach(ZonePrint{ what, zone });
+}
 
+bool Console::AnyFaulted()
+{
+  bool faulted{ false };
+  GZones.ForEach(ZoneAnyFaulted{ faulted });
+  return faulted;
+}
 
-
-// uid, target temp, max temp, sensor pin, relay pin
-TempController nico(1u, 24.0f, 28.0f, 2u, 8u);
-TempController trap(2u, 25.0f, 29.0f, 4u, 12u);
-
-//
-
-
+Console::SetResult Console::SetZone(uint16_t const uid, Config::Key const key, int16_t const value)
+{
+  SetResult result{ SetResult::NoZone };
+  GZones.ForEach(ZoneConfigure{ uid, key, value, result });
+  return result;
+}
 
 unsigned long GLastReadMs{ 0UL };
+unsigned long GLastHistoryMs{ 0UL };
+
 
 // -----------------------------------------------------------------------------
 // Arduino setup / loop
@@ -503,43 +4040,84 @@ unsigned long GLastReadMs{ 0UL };
 
 void setup()
 {
-  pinMode(LED_BUILTIN, OUTPUT);
-
-  nico.Begin();
-  trap.Begin();
+  Watchdog::CaptureResetCause();
+  Journal::Load();
+  Config::Load();
+  History::Begin();
+  Energy::Begin();
+  FastPin<LED_BUILTIN>::Output();
 
+  // before the zones: a sensor missing at boot is reported from Begin()
   Log::begin(115200);
+  // no Log without a PC, but the port still serves the history download
+  if(!CONNECT_TO_PC) Serial.begin(115200);
 
-  Log::println(F("\nNico temp controller starting..."));
-  Log::println(F("Target: 24 C, hysteresis: +/-0.5 C"));
+  SysLog::println(LOG_STR("\nNico temp controller starting..."));
+  SysLog::println(LOG_STR("Zones: "), ZONE_COUNT);
 
+  GZones.ForEach(ZoneBegin{});
 
-  Panic::Callback const cbs[] = 
-  {
-    [](){nico.Off();},
-    [](){trap.Off();}
-  };
-  Panic::Init(cbs);
+  Config::PrintSource();
+  Watchdog::PrintResetCause();
+  Journal::Dump();
+
+  InitPanicCallbacks(ZoneIndices{});
 
-  LEDMan::Register(&nico);
-  LEDMan::Register(&trap);
+  // a lockup is not something to heat through blindly after the reset
+  if(Watchdog::LastResetCause() == ResetCause::Watchdog)
+  {
+    PANIC(0, PanicReason::Watchdog);
+  }
 
+  Supervisor::Begin();
+  Watchdog::Begin();
 }
 
 void loop()
 {
+  Prof::Scope const scope{ ProfSection::Loop };
+  Log::pump();
+  Console::Poll();
+  Console::Update();
+  Journal::Update();
+  History::Update();
+  Config::Update();
+  Memory::Update();
+  Panic::Report();
+  Prof::Update();
+  Watchdog::CheckIn(Watchdog::LOOP);
+  Watchdog::Service();
+
+  // once latched the zones stop feeding the supervisor, so every slot trips on
+  // staleness; that is the panic working, not a new one
+  uint8_t tripped_uid{};
+  if(!Panic::IsPanic() && Supervisor::Tripped(tripped_uid))
+  {
+    PANIC(tripped_uid, PanicReason::SupervisorTrip);
+  }
+
   LEDMan::Update();
+  uint8_t heater{};
+  GZones.ForEach(ZoneHeaterBits{ heater, 1U });
+  Energy::Update(heater);
   unsigned long const now{ millis() };
-  if (now - GLastReadMs < READ_INTERVAL_MS) return;
-  GLastReadMs = now;
 
-  if (Panic::IsPanic())
+  // keeps going through a panic: that is exactly the stretch worth having afterwards
+  if (now - GLastHistoryMs >= HISTORY_INTERVAL_MS)
   {
-    Panic::PrintPanic();
-    return;
+    GLastHistoryMs = now;
+    History::Sample samples[History::ZONES];
+    GZones.ForEach(ZoneSample{ samples });
+    History::Record(samples);
   }
-  
 
-  nico.Loop();
-  trap.Loop();
+  GZones.ForEach(ZonePoll{});
+
+  if (now - GLastReadMs < Config::ReadIntervalMs()) return;
+  GLastReadMs = now;
+
+  if (Panic::IsPanic()) return; // Panic::Report() keeps the host informed
+
+  GZones.ForEach(ZoneLoop{});
+  Watchdog::CheckIn(Watchdog::CONTROL);
 }
\ No newline at end of file
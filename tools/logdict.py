@@ -0,0 +1,262 @@
+#!/usr/bin/env python3
+"""Host side of the board's binary/tokenized serial output.
+
+  logdict.py gen main.cpp > logdict.json
+      Scan the sketch for LOG_STR("...") and write the token -> text dictionary.
+      Fails on a token collision (rename one of the strings).
+
+  logdict.py decode logdict.json < capture.bin
+      Split a raw serial capture on 0x00, decode COBS + CRC16 frames and print
+      them; chunks that are not valid frames are printed as text.
+
+Must match the sketch: see Frame, LOG_STR, TokenFrame, Telemetry and History
+in main.cpp.
+"""
+import codecs
+import json
+import re
+import struct
+import sys
+
+LOG_STR_RE = re.compile(r'LOG_STR\(\s*"((?:[^"\\]|\\.)*)"\s*\)')
+
+FRAME_STATE = 1
+FRAME_TOKEN = 2
+FRAME_STATS = 3
+FRAME_HISTORY = 4
+
+HISTORY_FLAG_BOOT = 0x01
+
+STATE_NAMES = {0: "HEATING", 1: "COOLING", 2: "OFF", 3: "FAULT"}
+FLAG_PANIC = 0x01
+FLAG_DROPPED = 0x02
+
+# tag -> (struct format, size), see TokenFrame::Tag
+TAGS = {
+    0x01: ("<H", 2),  # TOKEN
+    0x02: ("<B", 1),  # U8
+    0x03: ("<h", 2),  # I16
+    0x04: ("<H", 2),  # U16
+    0x05: ("<i", 4),  # I32
+    0x06: ("<I", 4),  # U32
+    0x07: ("<f", 4),  # FLOAT
+    0x08: ("<c", 1),  # CHAR
+    0x09: ("<H", 2),  # DROPPED
+    0x0A: ("<h", 2),  # TEMP16
+}
+TAG_TOKEN = 0x01
+TAG_FLOAT = 0x07
+TAG_CHAR = 0x08
+TAG_DROPPED = 0x09
+TAG_TEMP16 = 0x0A
+TAG_MORE = 0x7E  # part of a longer line, see TokenFrame
+
+
+def token_of(text: bytes) -> int:
+    h = 2166136261
+    for b in text:
+        h = ((h ^ b) * 16777619) & 0xFFFFFFFF
+    return (h >> 16) ^ (h & 0xFFFF)
+
+
+def gen(path):
+    src = open(path, encoding="utf-8").read()
+    # the macro definition itself uses LOG_STR(s), not a literal, so it never matches
+    table = {}
+    for lit in LOG_STR_RE.findall(src):
+        text = codecs.escape_decode(lit.encode("utf-8"))[0]
+        tok = token_of(text)
+        known = table.get(tok)
+        if known is not None and known != text:
+            sys.exit("token collision 0x%04x: %r vs %r" % (tok, known, text))
+        table[tok] = text
+    out = {"%04x" % t: v.decode("latin-1") for t, v in sorted(table.items())}
+    json.dump(out, sys.stdout, indent=1, sort_keys=True)
+    sys.stdout.write("\n")
+
+
+def crc16(data: bytes) -> int:
+    crc = 0xFFFF
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) & 0xFFFF if crc & 0x8000 else (crc << 1) & 0xFFFF
+    return crc
+
+
+def cobs_decode(data: bytes):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            return None
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def frame_payload(chunk: bytes):
+    raw = cobs_decode(chunk)
+    if raw is None or len(raw) < 3:
+        return None
+    payload, crc = raw[:-2], struct.unpack("<H", raw[-2:])[0]
+    return payload if crc16(payload) == crc else None
+
+
+def decode_state(p):
+    if len(p) != 11:
+        return "STATE <bad length %d>" % len(p)
+    _, uid, raw, state, relay, flags, ms = struct.unpack("<BBhBBBI", p)
+    line = "%10u CTRL: %u Temp: %.4f ST: %s relay: %s" % (
+        ms, uid, raw / 16.0, STATE_NAMES.get(state, state), "ON" if relay else "OFF")
+    if flags & FLAG_PANIC:
+        line += " [panic]"
+    if flags & FLAG_DROPPED:
+        line += " [log dropped]"
+    return line
+
+
+def decode_stats(p):
+    if len(p) != 18:
+        return "STATS <bad length %d>" % len(p)
+    _, uid, n, lo, mean, hi, duty, sw, ms = struct.unpack("<BBHhhhHHI", p)
+    return "%10u STAT: %u n=%u min=%.2f mean=%.2f max=%.2f duty=%.1f%% sw=%u" % (
+        ms, uid, n, lo / 16.0, mean / 16.0, hi / 16.0, duty / 10.0, sw)
+
+
+def decode_history(p):
+    """One EEPROM page: keyframe header, then a nibble per zone per sample."""
+    if len(p) < 5:
+        return "HISTORY <bad length %d>" % len(p)
+    _, left, interval_s, zones = struct.unpack("<BBHB", p[:5])
+    hdr = "<H%dhBB" % zones
+    hdr_len = struct.calcsize(hdr)
+    page = p[5:]
+    if len(page) < hdr_len + 2:
+        return "HISTORY <bad length %d>" % len(p)
+    fields = struct.unpack(hdr, page[:hdr_len])
+    (crc,) = struct.unpack("<H", page[hdr_len:hdr_len + 2])
+    if crc16(page[:hdr_len]) != crc:
+        return "HISTORY page (%u left) <bad crc>" % left
+    seq, raw, flags, heater = fields[0], list(fields[1:1 + zones]), fields[-2], fields[-1]
+
+    lines = ["HISTORY seq=%u every %us%s (%u pages left)" % (
+        seq, interval_s, " [boot]" if flags & HISTORY_FLAG_BOOT else "", left)]
+
+    def row(n, raw, heat):
+        cells = ["%6.2f %s" % (r / 16.0, "ON " if h else "off") for r, h in zip(raw, heat)]
+        lines.append("  +%6us  %s" % (n * interval_s, "  ".join(cells)))
+
+    row(0, raw, [heater >> z & 1 for z in range(zones)])
+    per_sample = (zones + 1) // 2
+    data = page[hdr_len + 2:]
+    n = 0
+    for i in range(0, len(data) - per_sample + 1, per_sample):
+        chunk = data[i:i + per_sample]
+        if chunk[0] == 0xFF:
+            break
+        n += 1
+        heat = []
+        for z in range(zones):
+            nib = chunk[z // 2] >> (4 * (z % 2)) & 0x0F
+            raw[z] += (nib & 0x07) - 3
+            heat.append(nib >> 3)
+        row(n, raw, heat)
+    return "\n".join(lines)
+
+
+def decode_tokens(p, table):
+    """One part of a line: (text, dropped, continues a line, line goes on)."""
+    out = []
+    dropped = 0
+    more_in = more_out = False
+    i = 1
+    while i < len(p):
+        tag = p[i]
+        i += 1
+        if tag == TAG_MORE:
+            if i == 2:
+                more_in = True
+            else:
+                more_out = True
+            continue
+        if tag not in TAGS:
+            out.append("<bad tag 0x%02x>" % tag)
+            break
+        fmt, size = TAGS[tag]
+        (v,) = struct.unpack(fmt, p[i:i + size])
+        i += size
+        if tag == TAG_TOKEN:
+            out.append(table.get("%04x" % v, "<token %04x>" % v))
+        elif tag == TAG_DROPPED:
+            dropped = v
+        elif tag == TAG_TEMP16:
+            out.append("%.2f" % (v / 16.0))
+        elif tag == TAG_FLOAT:
+            out.append("%.2f" % v)
+        elif tag == TAG_CHAR:
+            out.append(v.decode("latin-1"))
+        else:
+            out.append(str(v))
+    return "".join(out), dropped, more_in, more_out
+
+
+def decode(dict_path):
+    table = json.load(open(dict_path, encoding="utf-8"))
+    data = sys.stdin.buffer.read()
+    line = None  # [text] of a tokenized line still waiting for its next part
+
+    def cut():
+        # the rest of the line was dropped
+        nonlocal line
+        if line is not None:
+            print(line[0] + "...[cut]")
+            line = None
+
+    for chunk in data.split(b"\x00"):
+        if not chunk:
+            continue
+        p = frame_payload(chunk)
+        if p is None or p[0] != FRAME_TOKEN:
+            cut()
+        if p is None:
+            sys.stdout.write(chunk.decode("latin-1"))
+        elif p[0] == FRAME_STATE:
+            print(decode_state(p))
+        elif p[0] == FRAME_STATS:
+            print(decode_stats(p))
+        elif p[0] == FRAME_TOKEN:
+            text, dropped, more_in, more_out = decode_tokens(p, table)
+            if more_in and line is None:
+                text = "[...]" + text  # its start was dropped
+            elif more_in:
+                text = line[0] + text
+            else:
+                cut()
+            line = None
+            if dropped:
+                text = "[dropped %u] %s" % (dropped, text)
+            if more_out:
+                line = [text]
+            else:
+                print(text)
+        elif p[0] == FRAME_HISTORY:
+            print(decode_history(p))
+        else:
+            print("<frame type %u: %s>" % (p[0], p.hex()))
+
+
+def main(argv):
+    if len(argv) == 3 and argv[1] == "gen":
+        gen(argv[2])
+    elif len(argv) == 3 and argv[1] == "decode":
+        decode(argv[2])
+    else:
+        sys.exit(__doc__)
+
+
+if __name__ == "__main__":
+    main(sys.argv)